@@ -2,8 +2,7 @@
 #include "Executive.h"
 #include "player.h"
 #include "display.h"
-#include "machine.h"
-#include "medium.h"
+#include "game_engine.h"
 #include <iostream>
 #include <limits>
 #include <string>
@@ -169,13 +168,12 @@ int Executive::numShipCoords(int shipNum)
     return n;
 }
 
-void Executive::WaitEnter()
+void Executive::WaitEnter(Display &display)
 {
     cin.ignore();
     cout << "Press ENTER to end turn...";
     cin.get();
-    for (int i = 0; i <= 50; i++)
-        cout << endl;
+    display.clear();
 }
 
 bool Executive::validColumn(bool big, char c)
@@ -197,63 +195,88 @@ bool Executive::validColumn(bool big, char c)
 
 void Executive::run()
 {
-    int shipnum = 0;
-
-    int row, col;
-    char c_col; // char version of the column
-
-    Machine machine;
-
-    int maxShips = 5;
-
-    int numRows = 9;
-    int numCols = 9;
-
     bool humanOpponent = true;
-    bool big = false;
+    char difficulty = 'E';
     char gamemode = getCharInOptions("Would you like to play normal Battleship or BattleshipXL?", "NX");
-    if (gamemode == 'X')
+    if (gamemode != 'X')
     {
-        numRows = 20;
-        numCols = 20;
-        maxShips = 10;
-        big = true;
-    } else {
         char humanInput = getCharInOptions("Would you like to play against a Human or AI?", "HA");
         humanOpponent = humanInput == 'H';
     }
 
-    Display display(big);
-    Player player1(big);
-    Player player2(big);
-
-
     if (!humanOpponent)
     {
-        char diff = getCharInOptions("What level of difficulty do you want to play: Easy, Medium, Hard?", "EMH");
-        machine.setDifficultyLevel(diff);
-        machine.setGameMode(gamemode);
+        difficulty = getCharInOptions("What level of difficulty do you want to play: Easy, Medium, Hard, or eXpert?", "EMHX");
+    }
+
+    if (gamemode == 'X')
+    {
+        play<XLBoard>(humanOpponent, difficulty);
+    }
+    else
+    {
+        play<NormalBoard>(humanOpponent, difficulty);
     }
+}
+
+template <class BoardType>
+void Executive::play(bool humanOpponent, char difficulty)
+{
+    int shipnum = 0;
+
+    int row, col;
+    char c_col; // char version of the column
+
+    const int numRows = BoardType::ROWS;
+    const int numCols = BoardType::COLS;
+    int maxShips = BoardType::checkBig() ? 10 : 5;
+
+    Display display(BoardType::checkBig());
 
     shipnum = getInt("How many ships do you want to place in the grid?", 1, maxShips);
 
-    player1.my_ships.updateNumShips(shipnum);
-    player1.enemy_ships.updateNumShips(shipnum);
-    player2.my_ships.updateNumShips(shipnum);
-    player2.enemy_ships.updateNumShips(shipnum);
+    GameEngine<BoardType> engine(shipnum, HUMAN_CONTROLLER, humanOpponent ? HUMAN_CONTROLLER : controllerForDifficulty(difficulty));
+
+    // The AI each side's controller names, on that side's streams of the game's seed
+    AnyStrategy<BoardType> strategies[2];
+    for (int side = 1; side <= 2; side++)
+    {
+        strategies[side - 1].setController(engine.getController(side));
+        strategies[side - 1].reset(engine.getSeed(), side);
+    }
 
-    Player *currentPlayer = &player1;
     for (int currentPlayerNum = 1; currentPlayerNum <= 2; currentPlayerNum++)
     {
-        cout << "Player " << currentPlayerNum << "\n";
+        if (engine.getController(currentPlayerNum) != HUMAN_CONTROLLER)
+        {
+            //blank Board
+            cin.ignore();
+            cout << "Press Enter to play!";
+            cin.get();
+            display.clear();
+
+            engine.placeFleet(currentPlayerNum);
+
+            display.friendlyBoard(engine.getPlayer(currentPlayerNum).my_ships);
+            cout<<"AI Board with ships placed\n";
+            continue;
+        }
+
+        Player<BoardType> &currentPlayer = engine.getPlayer(currentPlayerNum);
+        bool placeFailed = false;
 
         for (int currentShip = 1; currentShip <= shipnum; currentShip++)
         {
             while (true)
             {
 
-                //blank Board
-                display.friendlyBoard(currentPlayer->my_ships);
+                //blank Board; anything printed before it would be drawn over
+                display.friendlyBoard(currentPlayer.my_ships);
+                cout << "Player " << currentPlayerNum << "\n";
+                if (placeFailed)
+                {
+                    cout << "Ship could not be placed there. \n";
+                }
                 char direction = 'U'; //default direction is up
 
                 if (currentShip == 1)
@@ -283,11 +306,24 @@ void Executive::run()
                 row--;                  // decrement row by 1 for indexing array
                 direction = toupper(direction);
 
-                if (!currentPlayer->PlaceShip(currentShip, row, col, direction))
+                int orientation = 0;
+                if (direction == 'V' || direction == 'N')
                 {
-                    cout << "Ship could not be placed there. \n";
+                    //offer each way the bent ship can face, as drawn from the shape table
+                    const ShipShape<BoardType> *variants[ShipShape<BoardType>::MAX_VARIANTS];
+                    const ShipShape<BoardType> *bent[ShipShape<BoardType>::MAX_VARIANTS];
+                    int numVariants = ShipShape<BoardType>::variants(currentShip, variants);
+                    int numBent = 0;
+                    for (int i = 0; i < numVariants; i++)
+                    {
+                        if (variants[i]->getDirection() == direction) bent[numBent++] = variants[i];
+                    }
+                    display.shapeOptions(bent, numBent);
+                    orientation = bent[getInt("Which way should the ship face? (P is the pivot)", 1, numBent) - 1]->getOrientation();
                 }
-                else
+
+                placeFailed = !engine.placeShip(currentPlayerNum, currentShip, row, col, direction, orientation);
+                if (!placeFailed)
                 {
                     break;
                 }
@@ -295,147 +331,33 @@ void Executive::run()
         }
 
         //print last time so player can see 1x5 ship placed
-        display.friendlyBoard(currentPlayer->my_ships);
+        display.friendlyBoard(currentPlayer.my_ships);
 
-        if (humanOpponent)
+        if (currentPlayerNum == 1 && engine.getController(2) == HUMAN_CONTROLLER)
         {
             cout << "Switch to next Player!\n";
-            WaitEnter();
-
-            currentPlayer = &player2;
-        }
-        else
-        {
-            break;
+            WaitEnter(display);
         }
     }
 
-    if (!humanOpponent)
-    {
-        //blank Board
-
-        cin.ignore();
-        cout << "Press Enter to play!";
-        cin.get();
-        for (int i = 0; i <= 50; i++)
-            cout << endl;
-
-		
-        currentPlayer = &player2;
-        for (int currentShip = 1; currentShip <= shipnum; currentShip++)
-		{
-			while (true) {
-
-				//blank Board
-				char direction = 'u'; //default direction is up
-
-				if (currentShip == 1)
-				{
-					row = machine.randomNum();
-					col = machine.randomChar();
-				}
-				else
-				{
-					row = machine.randomNum();
-					col = machine.randomChar();
-					direction = machine.getRandomDirection();
-				}
-				 // decrement row by 1 for indexing array
-				direction = toupper(direction);
-                // cout << "Attempting " << row << ", " << col << ", " << direction << " for " << currentShip << "\n";
-				if (currentPlayer->PlaceShipAI(currentShip, row, col, direction))
-				{
-					break;
-				} 
-			}
-		}
-
-	}
-
-	int round = 0;
-
-	cout<<"AI Board with ships placed:\n";
-	display.friendlyBoard(currentPlayer->my_ships);
-
-
-
-    currentPlayer = &player1;
-    Player *otherPlayer = &player2;
-    Medium medium;
-
-	while (!player1.my_ships.allShipsSunk() && !player2.my_ships.allShipsSunk())
+	while (!engine.isOver())
 	{
-        if (round % 2) {
+        int playerNum = engine.getCurrentSide();
+        Player<BoardType> &currentPlayer = engine.getPlayer(playerNum);
 
-            currentPlayer = &player2;
-            otherPlayer = &player1;
-        }
-        else
-        {
-            currentPlayer = &player1;
-            otherPlayer = &player2;
-        }
-        int playerNum = (round % 2) + 1;
-
-        if (playerNum == 2 && !humanOpponent) 
+        if (engine.getController(playerNum) != HUMAN_CONTROLLER) 
 		{
-            if(machine.getDifficultyLevel() == 'E')
-			{
-				row = machine.randomNum();
-                col = machine.randomChar();
-
-                while (otherPlayer->my_ships.getValue(row, col) == 'X' || currentPlayer->enemy_ships.getValue(row, col) == 'O')
-                {
-                    row = machine.randomNum();
-                    col = machine.randomChar();
-                }
-
-                if (otherPlayer->CheckHit(row, col))
-                {
-                    currentPlayer->UpdateEnemyBoard(row, col, true);
-                    if (otherPlayer->my_ships.allShipsSunk())
-                    {
-                        cout << "The Machine wins!\n";
-                    }
-                }
-                else
-                {
-                    currentPlayer->UpdateEnemyBoard(row, col, false);
-                    otherPlayer->my_ships.updateBoard(row, col, 'O');
-                }
-
-			}
-			else if (machine.getDifficultyLevel() == 'M')
-			{
-				medium.solve(player1, player2);
-			}
-			else
-			{
-				for (int i = 0; i < numRows*numCols; i++) 
-				{
-                    row = i / numRows;
-                    col = i % numCols;
-                    if(player1.CheckHit(row, col))
-					{
-                        break;
-                    }
-                }
-                currentPlayer->UpdateEnemyBoard(row, col, true);
-                if (otherPlayer->my_ships.allShipsSunk())
-                {
-                    cout << "The Machine wins!\n";
-                }
-                
-                
+            auto quiet = [](int, int, const Shot &) {};
+            if (playTurn(engine, strategies[playerNum - 1], playerNum, quiet) == SHOT_WIN)
+            {
+                cout << "The Machine wins!\n";
             }
-			round++;
 		}
-			
 		else {
-            cout << "Player " << playerNum << "'s turn!\n";
-            cout << "You have been hit " << currentPlayer->my_ships.getNumHits() << " times\n";
             //Print boards before fire
-            display.matchFrame(playerNum, currentPlayer->enemy_ships, currentPlayer->my_ships);
+            display.matchFrame(playerNum, currentPlayer.enemy_ships, currentPlayer.my_ships);
+            cout << "Player " << playerNum << "'s turn!\n";
+            cout << "You have been hit " << currentPlayer.my_ships.getNumHits() << " times\n";
 
             while (true)
             {
@@ -444,30 +366,27 @@ void Executive::run()
                 col = charToInt(c_col);
                 row--;
 
-                if (otherPlayer->CheckHit(row, col))
+                ShotResult result = engine.fire(row, col).result;
+                if (result == SHOT_INVALID)
                 {
-                    display.hit();
-                    currentPlayer->UpdateEnemyBoard(row, col, true);
-                    if (otherPlayer->my_ships.allShipsSunk())
-                    {
-                        cout << "Player " << playerNum << " wins!\n";
-                    }
-                    break;
+                    cout << "\n\nYou've already fired at that spot!\n";
+                    continue;
                 }
-                else if (otherPlayer->my_ships.getValue(row, col) == 'X' || currentPlayer->enemy_ships.getValue(row, col) == 'O')
+                if (result == SHOT_MISS)
                 {
-                    cout << "\n\nYou've already fired at that spot!\n";
+                    display.miss();
                 }
                 else
                 {
-                    display.miss();
-                    currentPlayer->UpdateEnemyBoard(row, col, false);
-                    otherPlayer->my_ships.updateBoard(row, col, 'O');
-                    break;
+                    display.hit();
+                    if (result == SHOT_WIN)
+                    {
+                        cout << "Player " << playerNum << " wins!\n";
+                    }
                 }
+                break;
             }
-			round++;
-        	WaitEnter();
+        	WaitEnter(display);
         }
 
 	}
@@ -3,6 +3,7 @@
 
 #include "board.h"
 #include "player.h"
+#include "display.h"
 
 #include <iostream>
 using namespace std;
@@ -23,10 +24,11 @@ public:
 	~Executive(){};
 
     /**
-     * @brief Output several newlines to clear the terminal screen and then wait for enter 
+     * @brief Wait for enter and then clear the terminal screen
      * 
+     * @param display The display whose frame to clear down to
      */
-	void WaitEnter();
+	void WaitEnter(Display &display);
 
 
     /**
@@ -61,5 +63,17 @@ public:
      */
   	int numShipCoords(int shipNum);
 
+private:
+
+    /**
+     * @brief Play a game of battleship on the given board type once the opponent has been chosen
+     * 
+     * @tparam BoardType NormalBoard or XLBoard
+     * @param humanOpponent Whether player 2 is a human
+     * @param difficulty The AI difficulty level ('E', 'M', 'H' or 'X'), if player 2 is not a human
+     */
+    template <class BoardType>
+    void play(bool humanOpponent, char difficulty);
+
 };
 #endif // EXECUTIVE_H
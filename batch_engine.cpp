@@ -0,0 +1,271 @@
+#include "batch_engine.h"
+#include "fleet.h"
+#include "machine.h"
+
+// BATCH_SCALAR builds the scalar kernel even where SSE2 or AVX2 is available, so it can be tested
+#if defined(__AVX2__) && !defined(BATCH_SCALAR)
+#include <immintrin.h>
+#elif defined(__SSE2__) && !defined(BATCH_SCALAR)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    /*
+     * One register of 64-bit lanes for fire()'s kernel. Each has the same
+     * static members; zero() gives all ones in the lanes which are 0 and 0
+     * in the others, as the compare instructions do.
+     */
+
+    struct ScalarLanes
+    {
+        typedef uint64_t V;
+        static const int WIDTH = 1;
+        static const char *name() { return "scalar"; }
+
+        static V load(const uint64_t *p) { return *p; }
+        static void store(uint64_t *p, V a) { *p = a; }
+        static V set1(uint64_t a) { return a; }
+        static V bitAnd(V a, V b) { return a & b; }
+        static V bitOr(V a, V b) { return a | b; }
+        static V andNot(V a, V b) { return ~a & b; }
+        static V add(V a, V b) { return a + b; }
+        static V sub(V a, V b) { return a - b; }
+        static V zero(V a) { return a == 0 ? ~uint64_t(0) : 0; }
+    };
+
+#if defined(BATCH_SCALAR)
+    typedef ScalarLanes VectorLanes;
+#elif defined(__AVX2__)
+    struct VectorLanes
+    {
+        typedef __m256i V;
+        static const int WIDTH = 4;
+        static const char *name() { return "avx2"; }
+
+        static V load(const uint64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+        static void store(uint64_t *p, V a) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a); }
+        static V set1(uint64_t a) { return _mm256_set1_epi64x(static_cast<long long>(a)); }
+        static V bitAnd(V a, V b) { return _mm256_and_si256(a, b); }
+        static V bitOr(V a, V b) { return _mm256_or_si256(a, b); }
+        static V andNot(V a, V b) { return _mm256_andnot_si256(a, b); }
+        static V add(V a, V b) { return _mm256_add_epi64(a, b); }
+        static V sub(V a, V b) { return _mm256_sub_epi64(a, b); }
+        static V zero(V a) { return _mm256_cmpeq_epi64(a, _mm256_setzero_si256()); }
+    };
+#elif defined(__SSE2__)
+    struct VectorLanes
+    {
+        typedef __m128i V;
+        static const int WIDTH = 2;
+        static const char *name() { return "sse2"; }
+
+        static V load(const uint64_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+        static void store(uint64_t *p, V a) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a); }
+        static V set1(uint64_t a) { return _mm_set1_epi64x(static_cast<long long>(a)); }
+        static V bitAnd(V a, V b) { return _mm_and_si128(a, b); }
+        static V bitOr(V a, V b) { return _mm_or_si128(a, b); }
+        static V andNot(V a, V b) { return _mm_andnot_si128(a, b); }
+        static V add(V a, V b) { return _mm_add_epi64(a, b); }
+        static V sub(V a, V b) { return _mm_sub_epi64(a, b); }
+
+        // SSE2 compares 32 bits at a time: a 64-bit lane is 0 when both its halves are
+        static V zero(V a)
+        {
+            V halves = _mm_cmpeq_epi32(a, _mm_setzero_si128());
+            return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    };
+#else
+    typedef ScalarLanes VectorLanes;
+#endif
+
+    /**
+     * @brief The layers of one defending side, as fire()'s kernel reads and writes them
+     *
+     */
+    struct SideLayers
+    {
+        const uint64_t (*ships)[BatchEngine::LANES];
+        uint64_t (*hits)[BatchEngine::LANES];
+        uint64_t (*misses)[BatchEngine::LANES];
+        const uint64_t (*shipMasks)[BatchEngine::WORDS][BatchEngine::LANES];
+        uint64_t (*remaining)[BatchEngine::LANES];
+        uint64_t *floating;
+    };
+
+    /**
+     * @brief Resolve one shot per lane, Lanes::WIDTH lanes per step
+     *
+     * bits holds each lane's target cell as a one-bit mask, or no bits in a
+     * lane which does not fire. The outcome comes out as 0 to 3 (SHOT_MISS to
+     * SHOT_WIN): each of hit, sunk and win is an all-ones mask, and negating
+     * their sum counts them.
+     */
+    template <class Lanes>
+    void resolve(const SideLayers &side, int numShips, const uint64_t bits[][BatchEngine::LANES],
+                 uint64_t results[], uint64_t ships[])
+    {
+        typedef typename Lanes::V V;
+        const V ones = Lanes::set1(~uint64_t(0));
+        const V none = Lanes::set1(0);
+
+        for (int lane = 0; lane < BatchEngine::LANES; lane += Lanes::WIDTH)
+        {
+            V struck = none;
+            V target[BatchEngine::WORDS];
+            for (int w = 0; w < BatchEngine::WORDS; w++)
+            {
+                target[w] = Lanes::load(bits[w] + lane);
+                V onShip = Lanes::load(side.ships[w] + lane);
+                V hit = Lanes::bitAnd(onShip, target[w]);
+                struck = Lanes::bitOr(struck, hit);
+                Lanes::store(side.hits[w] + lane, Lanes::bitOr(Lanes::load(side.hits[w] + lane), hit));
+                Lanes::store(side.misses[w] + lane, Lanes::bitOr(Lanes::load(side.misses[w] + lane), Lanes::andNot(onShip, target[w])));
+            }
+            V hit = Lanes::andNot(Lanes::zero(struck), ones);
+
+            V sunk = none;
+            V ship = none;
+            for (int s = 1; s <= numShips; s++)
+            {
+                V cell = none;
+                for (int w = 0; w < BatchEngine::WORDS; w++) cell = Lanes::bitOr(cell, Lanes::bitAnd(Lanes::load(side.shipMasks[s][w] + lane), target[w]));
+                V on = Lanes::andNot(Lanes::zero(cell), ones);
+                V left = Lanes::add(Lanes::load(side.remaining[s] + lane), on);
+                Lanes::store(side.remaining[s] + lane, left);
+                sunk = Lanes::bitOr(sunk, Lanes::bitAnd(on, Lanes::zero(left)));
+                ship = Lanes::bitOr(ship, Lanes::bitAnd(on, Lanes::set1(s)));
+            }
+            V floating = Lanes::add(Lanes::load(side.floating + lane), sunk);
+            Lanes::store(side.floating + lane, floating);
+            V win = Lanes::bitAnd(sunk, Lanes::zero(floating));
+
+            Lanes::store(results + lane, Lanes::sub(none, Lanes::add(Lanes::add(hit, sunk), win)));
+            Lanes::store(ships + lane, ship);
+        }
+    }
+}
+
+BatchEngine::BatchEngine(int numShips) : m_numShips(numShips)
+{
+    for (int lane = 0; lane < LANES; lane++)
+    {
+        m_live[lane] = 0;
+        m_winner[lane] = 0;
+    }
+}
+
+const char *BatchEngine::kernelName() { return VectorLanes::name(); }
+
+void BatchEngine::start(int lane, uint64_t seed)
+{
+    // The draws GameEngine makes: its placement machine is stream 0 of the seed
+    Machine &machine = m_machines[lane];
+    machine.seed(seed, 0);
+    machine.setGameMode('N');
+    FleetGenerator<BoardType> generator(m_numShips);
+
+    for (int d = 0; d < 2; d++)
+    {
+        Player<BoardType> player;
+        player.my_ships.updateNumShips(m_numShips);
+        Fleet<BoardType> fleet;
+        fleet.numShips = m_numShips;
+        if (generator.generate(machine, fleet)) FleetGenerator<BoardType>::apply(fleet, player);
+
+        m_floating[d][lane] = 0;
+        m_marks[d][lane] = 0;
+        for (int w = 0; w < WORDS; w++)
+        {
+            m_ships[d][w][lane] = player.my_ships.getOccupiedMask().m_words[w];
+            m_hits[d][w][lane] = 0;
+            m_misses[d][w][lane] = 0;
+        }
+        for (int s = 0; s <= MAX_SHIP_NUM; s++)
+        {
+            const Mask &cells = player.my_ships.getShipMask(s);
+            for (int w = 0; w < WORDS; w++) m_shipMasks[d][s][w][lane] = cells.m_words[w];
+            m_remaining[d][s][lane] = s == 0 ? 0 : cells.count();
+            if (m_remaining[d][s][lane] != 0) m_floating[d][lane]++;
+        }
+        m_untried[d][lane].reset();
+        m_sinkings[d][lane].reset();
+    }
+    m_live[lane] = ~uint64_t(0);
+    m_winner[lane] = 0;
+}
+
+bool BatchEngine::anyLive() const
+{
+    for (int lane = 0; lane < LANES; lane++)
+    {
+        if (m_live[lane]) return true;
+    }
+    return false;
+}
+
+EnemyView<BatchEngine::BoardType> BatchEngine::view(int lane, int side) const
+{
+    int defender = 2 - side;
+    EnemyView<BoardType> view;
+    for (int w = 0; w < WORDS; w++)
+    {
+        view.hits.m_words[w] = m_hits[defender][w][lane];
+        view.misses.m_words[w] = m_misses[defender][w][lane];
+    }
+    view.marks = m_marks[defender][lane];
+    view.sunk = m_sinkings[side - 1][lane].cells();
+    view.sunkShips = m_sinkings[side - 1][lane].ships();
+    view.numShips = m_numShips;
+    view.untried = &m_untried[side - 1][lane];
+    return view;
+}
+
+void BatchEngine::fire(int side, const int cells[LANES], Shot shots[LANES])
+{
+    int defender = 2 - side;
+    UntriedCells<BoardType::CELLS> *untried = m_untried[side - 1];
+
+    // Each firing lane's target as a one-bit mask; the rest fire at nothing
+    uint64_t bits[WORDS][LANES];
+    bool fires[LANES];
+    for (int lane = 0; lane < LANES; lane++)
+    {
+        int cell = cells[lane];
+        fires[lane] = m_live[lane] && cell >= 0 && cell < BoardType::CELLS && untried[lane].contains(cell);
+        for (int w = 0; w < WORDS; w++) bits[w][lane] = 0;
+        if (fires[lane]) bits[cell >> 6][lane] = uint64_t(1) << (cell & 63);
+    }
+
+    SideLayers layers = {m_ships[defender], m_hits[defender], m_misses[defender],
+                         m_shipMasks[defender], m_remaining[defender], m_floating[defender]};
+    uint64_t results[LANES];
+    uint64_t ships[LANES];
+    resolve<VectorLanes>(layers, m_numShips, bits, results, ships);
+
+    for (int lane = 0; lane < LANES; lane++)
+    {
+        if (!fires[lane])
+        {
+            shots[lane].result = SHOT_INVALID;
+            shots[lane].ship = 0;
+            continue;
+        }
+        untried[lane].remove(cells[lane]);
+        shots[lane].result = static_cast<ShotResult>(results[lane]);
+        shots[lane].ship = static_cast<int>(ships[lane]);
+        m_marks[defender][lane] ^= Zobrist::key(shots[lane].result == SHOT_MISS ? Zobrist::MISS : Zobrist::HIT, cells[lane]);
+        if (shots[lane].result >= SHOT_SUNK)
+        {
+            Mask hits;
+            for (int w = 0; w < WORDS; w++) hits.m_words[w] = m_hits[defender][w][lane];
+            m_sinkings[side - 1][lane].record(shots[lane].ship, cells[lane], hits);
+        }
+        if (shots[lane].result == SHOT_WIN)
+        {
+            m_live[lane] = 0;
+            m_winner[lane] = side;
+        }
+    }
+}
@@ -0,0 +1,206 @@
+/*------------------------------------------------------------
+ * @Filename: batch_engine.h
+ * @Description: LANES independent 9x9 games advanced together, one vector instruction stream per shot
+ ------------------------------------------------------------*/
+
+#ifndef BATCH_ENGINE_H
+#define BATCH_ENGINE_H
+
+#include "board.h"
+#include "player.h"
+#include "strategy.h"
+#include "untried_cells.h"
+#include <cassert>
+
+/**
+ * @brief Plays LANES games of 9x9 battleship side by side, without Player or Board objects
+ *
+ * Every layer is kept in struct-of-arrays form, indexed [defending side][..][lane]:
+ * the ship, hit and miss bitboards word by word, each ship's cells, the 'S'
+ * cells left per ship and the ships still floating, all as 64-bit lanes, and
+ * the Zobrist hash of the hits and misses. fire() then resolves one shot in
+ * every lane at once with the same and/or/compare steps Board::receiveShot
+ * takes for one board, 4 lanes per AVX2 instruction or 2 per SSE2 instruction
+ * (scalar code where neither is available, or when built with BATCH_SCALAR),
+ * and updates the hash as Board::receiveShot does. A lane whose game is over
+ * is masked out of later shots until start() refills it.
+ *
+ * Fleets are placed exactly as GameEngine(numShips, .., seed) with
+ * placeFleet(1) and placeFleet(2) would place them, so a lane driven by
+ * playBatch replays the scalar game of the same seed shot for shot.
+ */
+class BatchEngine
+{
+    public:
+        typedef NormalBoard BoardType;
+        typedef BoardType::Mask Mask;
+
+        static const int LANES = 16;
+        static const int WORDS = Mask::WORDS;
+        static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+
+        /**
+         * @brief Construct an engine with every lane finished
+         *
+         * @param numShips The number of ships per player
+         */
+        explicit BatchEngine(int numShips);
+
+        /**
+         * @brief Name the instruction set fire() was built for
+         *
+         * @return const char* "avx2", "sse2" or "scalar"
+         */
+        static const char *kernelName();
+
+        /**
+         * @brief Start a new game in a lane, placing both fleets from the seed
+         *
+         * @param lane The lane, 0 to LANES - 1
+         * @param seed The game's seed, as given to GameEngine
+         */
+        void start(int lane, uint64_t seed);
+
+        /**
+         * @brief Check whether a lane's game is still running
+         *
+         */
+        bool isLive(int lane) const { return m_live[lane] != 0; }
+
+        /**
+         * @brief Check whether any lane's game is still running
+         *
+         */
+        bool anyLive() const;
+
+        /**
+         * @brief Get the side which won a lane's game
+         *
+         * @return int 1 or 2, or 0 while the game is still running (or was never started)
+         */
+        int getWinner(int lane) const { return m_winner[lane]; }
+
+        /**
+         * @brief Get what a side knows of the enemy board in a lane
+         *
+         * @param lane The lane
+         * @param side The side firing (1 or 2)
+         * @return EnemyView<BoardType> The side's hits and misses, the ships it has sunk and its untried cells
+         */
+        EnemyView<BoardType> view(int lane, int side) const;
+
+        /**
+         * @brief Draw an untried cell for a side in a lane, as GameEngine::randomUntried does
+         *
+         * @param lane The lane
+         * @param side The side firing (1 or 2)
+         * @return int The cell (row * numCols + col)
+         */
+        int randomUntried(int lane, int side) { return m_untried[side - 1][lane].sample(m_machines[lane]); }
+
+        /**
+         * @brief One side fires once in every live lane
+         *
+         * @param side The side firing (1 or 2)
+         * @param cells The cell (row * numCols + col) each lane fires at; read only in live lanes
+         * @param shots Set to each lane's outcome, as Player::Fire reports it. Finished lanes,
+         *              and lanes firing off the board or at a cell already tried, get
+         *              SHOT_INVALID and nothing changes there. A SHOT_WIN finishes the lane.
+         */
+        void fire(int side, const int cells[LANES], Shot shots[LANES]);
+
+    private:
+        // [defending side 0 or 1][word][lane]
+        uint64_t m_ships[2][WORDS][LANES];
+        uint64_t m_hits[2][WORDS][LANES];
+        uint64_t m_misses[2][WORDS][LANES];
+        uint64_t m_shipMasks[2][MAX_SHIP_NUM + 1][WORDS][LANES];
+        uint64_t m_remaining[2][MAX_SHIP_NUM + 1][LANES];   // two's complement, so lanes count down by adding all-ones masks
+        uint64_t m_floating[2][LANES];
+        uint64_t m_marks[2][LANES];   // the Zobrist hash of the hits and misses, as Board::getHash keeps it
+
+        UntriedCells<BoardType::CELLS> m_untried[2][LANES];   // [firing side 0 or 1][lane]
+        Sinkings<BoardType> m_sinkings[2][LANES];             // [firing side 0 or 1][lane], as Player::sinkings
+        Machine m_machines[LANES];   // each lane's placement stream, carried on past the fleets as GameEngine's is
+        uint64_t m_live[LANES];   // all ones while the lane's game runs, else 0
+        int m_winner[LANES];
+        int m_numShips;
+};
+
+/**
+ * @brief Let each live lane's strategy for a side choose a shot, and fire them all
+ *
+ * A lane whose strategy chooses a cell already fired at is handled as
+ * playTurn handles it: debug builds stop, others fire that lane again at
+ * engine.randomUntried, so no lane stays live forever.
+ *
+ * @return bool Whether any lane fired
+ */
+template <class Strategy, class OnShot>
+bool playBatchTurn(BatchEngine &engine, Strategy strategies[], int side, OnShot &onShot)
+{
+    int cells[BatchEngine::LANES];
+    Shot shots[BatchEngine::LANES];
+    bool fired = false;
+    for (int lane = 0; lane < BatchEngine::LANES; lane++)
+    {
+        cells[lane] = engine.isLive(lane) ? strategies[lane].select(engine.view(lane, side)) : -1;
+        fired = fired || cells[lane] >= 0;
+    }
+    if (!fired) return false;
+
+    engine.fire(side, cells, shots);
+
+    int retries[BatchEngine::LANES];
+    bool retry = false;
+    for (int lane = 0; lane < BatchEngine::LANES; lane++)
+    {
+        retries[lane] = -1;
+        if (cells[lane] < 0 || shots[lane].result != SHOT_INVALID) continue;
+        assert(!"a strategy chose a cell already fired at");
+        retries[lane] = cells[lane] = engine.randomUntried(lane, side);
+        retry = true;
+    }
+    if (retry)
+    {
+        Shot again[BatchEngine::LANES];
+        engine.fire(side, retries, again);
+        for (int lane = 0; lane < BatchEngine::LANES; lane++)
+        {
+            if (retries[lane] >= 0) shots[lane] = again[lane];
+        }
+    }
+
+    for (int lane = 0; lane < BatchEngine::LANES; lane++)
+    {
+        if (shots[lane].result == SHOT_INVALID) continue;
+        strategies[lane].observe(cells[lane], shots[lane]);
+        onShot(lane, side, cells[lane], shots[lane]);
+    }
+    return true;
+}
+
+/**
+ * @brief Play up to LANES games to the end, side 1 with first[lane] and side 2 with second[lane]
+ *
+ * Lane i plays the game of seeds[i] and resets its strategies for it, so
+ * with mask-based strategies (see strategy.h) every lane matches what
+ * GameEngine and playGame do with that seed. Read the winners with
+ * engine.getWinner(lane) afterwards.
+ *
+ * @param count The number of games, at most LANES; lanes from count on stay finished
+ * @param onShot Called as onShot(lane, side, cell, shot) after every shot
+ */
+template <class First, class Second, class OnShot>
+void playBatch(BatchEngine &engine, const uint64_t seeds[], int count, First first[], Second second[], OnShot onShot)
+{
+    for (int lane = 0; lane < count; lane++)
+    {
+        engine.start(lane, seeds[lane]);
+        first[lane].reset(seeds[lane], 1);
+        second[lane].reset(seeds[lane], 2);
+    }
+    while (playBatchTurn(engine, first, 1, onShot) && playBatchTurn(engine, second, 2, onShot)) {}
+}
+
+#endif
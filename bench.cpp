@@ -0,0 +1,422 @@
+/*------------------------------------------------------------
+ * @Filename: bench.cpp
+ * @Description: battleship-bench, times the hot paths of the engine and prints JSON
+ ------------------------------------------------------------*/
+
+#include "game_engine.h"
+#include "batch_engine.h"
+#include "display.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Command line settings for a benchmark run
+ *
+ */
+struct BenchOptions
+{
+    double minSeconds = 0.25;   // each benchmark repeats until it has run at least this long
+    string filter;              // only run benchmarks whose name contains this
+    uint64_t seed = 1;
+};
+
+/**
+ * @brief What one timed run of a benchmark did
+ *
+ */
+struct Sample
+{
+    long ops;
+    double seconds;
+};
+
+/**
+ * @brief The result of one benchmark, as printed
+ *
+ */
+struct BenchResult
+{
+    string name;
+    long ops;
+    double seconds;
+};
+
+/**
+ * @brief A stream buffer which throws everything away, so Display can be timed without a terminal
+ *
+ */
+class NullBuffer : public streambuf
+{
+    protected:
+        int overflow(int c) { return c == EOF ? 0 : c; }
+        streamsize xsputn(const char *, streamsize count) { return count; }
+};
+
+// Results are folded into this so the compiler cannot drop the work being timed
+volatile long g_sink = 0;
+
+/**
+ * @brief Run a benchmark with more and more iterations until one run lasts long enough, and record it
+ *
+ * @param body Called with an iteration count; does the work and returns how many operations it timed in how long
+ */
+template <class Body>
+void run(const BenchOptions &options, vector<BenchResult> &results, const string &name, Body body)
+{
+    if (name.find(options.filter) == string::npos) return;
+
+    long iterations = 1;
+    while (true)
+    {
+        Sample sample = body(iterations);
+        if (sample.seconds >= options.minSeconds || iterations >= (1L << 40))
+        {
+            BenchResult result = {name, sample.ops, sample.seconds};
+            results.push_back(result);
+            return;
+        }
+        // Aim a little past the target so the next run is usually the last
+        double scale = sample.seconds > 0 ? 1.2 * options.minSeconds / sample.seconds : 100;
+        iterations = static_cast<long>(iterations * (scale < 2 ? 2 : scale > 100 ? 100 : scale));
+    }
+}
+
+/**
+ * @brief Time a loop which does one operation per iteration
+ *
+ */
+template <class Step>
+Sample timed(long iterations, Step step)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) step(i);
+    Sample sample = {iterations, chrono::duration<double>(chrono::steady_clock::now() - start).count()};
+    return sample;
+}
+
+/**
+ * @brief Set up a fresh pair of players with random fleets, attacker first
+ *
+ */
+template <class BoardType>
+void newGame(Machine &rng, int numShips, Player<BoardType> &attacker, Player<BoardType> &defender)
+{
+    FleetGenerator<BoardType> generator(numShips);
+    Fleet<BoardType> fleet;
+    Player<BoardType> *players[2] = {&attacker, &defender};
+    for (int i = 0; i < 2; i++)
+    {
+        *players[i] = Player<BoardType>();
+        players[i]->SetNumShips(numShips);
+        players[i]->my_ships.updateNumShips(numShips);
+        players[i]->enemy_ships.updateNumShips(numShips);
+        generator.generate(rng, fleet);
+        FleetGenerator<BoardType>::apply(fleet, *players[i]);
+    }
+}
+
+/**
+ * @brief Time one strategy's shot selection over whole one-sided games, only counting the choosing
+ *
+ * Each call is timed on its own, so the result includes one clock/pair
+ * (reported separately) per operation.
+ */
+template <class BoardType, class Strategy>
+Sample aiShots(uint64_t seed, int numShips, long games)
+{
+    Machine rng(seed, 7);
+    Player<BoardType> attacker;
+    Player<BoardType> defender;
+    Strategy strategy;
+    Sample sample = {0, 0};
+    for (long game = 0; game < games; game++)
+    {
+        newGame(rng, numShips, attacker, defender);
+        strategy.reset(seed + game, 1);
+        while (!defender.my_ships.allShipsSunk())
+        {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            int cell = strategy.select(attacker, defender);
+            sample.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            sample.ops++;
+            strategy.observe(cell, attacker.Fire(defender, cell / BoardType::COLS, cell % BoardType::COLS));
+        }
+    }
+    return sample;
+}
+
+/**
+ * @brief Every benchmark for one board size
+ *
+ * @param label The board size, prefixed to each name
+ * @param numShips The fleet to play with
+ */
+template <class BoardType>
+void boardBenchmarks(const BenchOptions &options, vector<BenchResult> &results, const string &label, int numShips)
+{
+    const int CELLS = BoardType::CELLS;
+    const int COLS = BoardType::COLS;
+
+    // A game half played out, shared by the board and player benchmarks
+    Machine rng(options.seed, 1);
+    Player<BoardType> attacker;
+    Player<BoardType> defender;
+    newGame(rng, numShips, attacker, defender);
+    const Player<BoardType> freshDefender = defender;
+    for (int shot = 0; shot < CELLS / 2; shot++)
+    {
+        int cell = attacker.untried_cells.sample(rng);
+        attacker.Fire(defender, cell / COLS, cell % COLS);
+    }
+    if (defender.my_ships.allShipsSunk()) defender = freshDefender;
+
+    run(options, results, label + "/board/getValue", [&](long iterations) {
+        long sum = 0;
+        Sample sample = timed(iterations, [&](long i) {
+            int cell = static_cast<int>(i % CELLS);
+            sum += defender.my_ships.getValue(cell / COLS, cell % COLS);
+        });
+        g_sink += sum;
+        return sample;
+    });
+
+    run(options, results, label + "/board/updateBoard", [&](long iterations) {
+        BoardType board = freshDefender.my_ships;
+        Sample sample = timed(iterations, [&](long i) {
+            int cell = static_cast<int>(i % CELLS);
+            board.updateBoard(cell / COLS, cell % COLS, (i / CELLS) % 2 ? 'X' : 'O');
+        });
+        g_sink += board.getNumHits();
+        return sample;
+    });
+
+    run(options, results, label + "/board/shipNumIsSunk", [&](long iterations) {
+        long sunk = 0;
+        Sample sample = timed(iterations, [&](long i) {
+            sunk += defender.my_ships.shipNumIsSunk(static_cast<int>(i % numShips) + 1);
+        });
+        g_sink += sunk;
+        return sample;
+    });
+
+    run(options, results, label + "/board/allShipsSunk", [&](long iterations) {
+        long sunk = 0;
+        Sample sample = timed(iterations, [&](long) { sunk += defender.my_ships.allShipsSunk(); });
+        g_sink += sunk;
+        return sample;
+    });
+
+    // PlaceShip changes the board, so each placement starts from a copy of an empty player
+    const Player<BoardType> empty;
+    run(options, results, label + "/player/copy", [&](long iterations) {
+        Player<BoardType> player;
+        Sample sample = timed(iterations, [&](long) { player = empty; });
+        g_sink += player.my_ships.getNumShips();
+        return sample;
+    });
+
+    // Every direction of a straight ship, and every distinct orientation of the bent ones
+    struct Way
+    {
+        int size;
+        char direction;
+        int orientation;
+    };
+    vector<Way> ways;
+    for (const char *direction = "UDLR"; *direction; direction++)
+    {
+        Way way = {4, *direction, 0};
+        ways.push_back(way);
+    }
+    for (int size = 5; size <= 7 && size <= numShips; size += 2)
+    {
+        const ShipShape<BoardType> *shapes[ShipShape<BoardType>::MAX_VARIANTS];
+        int numShapes = ShipShape<BoardType>::variants(size, shapes);
+        for (int v = 0; v < numShapes; v++)
+        {
+            char direction = shapes[v]->getDirection();
+            if (direction != 'V' && direction != 'N') continue;
+            Way way = {size, direction, shapes[v]->getOrientation()};
+            ways.push_back(way);
+        }
+    }
+
+    for (size_t w = 0; w < ways.size(); w++)
+    {
+        const Way way = ways[w];
+        string name = label + "/player/PlaceShip/" + to_string(way.size) + way.direction;
+        if (way.direction == 'V' || way.direction == 'N') name += to_string(way.orientation);
+        run(options, results, name, [&](long iterations) {
+            Player<BoardType> player;
+            long placed = 0;
+            Sample sample = timed(iterations, [&](long i) {
+                int cell = static_cast<int>(i % CELLS);
+                player = empty;
+                placed += player.PlaceShip(way.size, cell / COLS, cell % COLS, way.direction, way.orientation);
+            });
+            g_sink += placed;
+            return sample;
+        });
+    }
+
+    run(options, results, label + "/player/CheckHit", [&](long iterations) {
+        Player<BoardType> player = freshDefender;
+        long hits = 0;
+        Sample sample = timed(iterations, [&](long i) {
+            int cell = static_cast<int>(i % CELLS);
+            if (cell == 0) player = freshDefender;   // once per pass over the board
+            hits += player.CheckHit(cell / COLS, cell % COLS);
+        });
+        g_sink += hits;
+        return sample;
+    });
+
+    run(options, results, label + "/player/Fire", [&](long iterations) {
+        const Player<BoardType> freshAttacker;
+        Player<BoardType> shooter = freshAttacker;
+        Player<BoardType> target = freshDefender;
+        long hits = 0;
+        Sample sample = timed(iterations, [&](long i) {
+            int cell = static_cast<int>(i % CELLS);
+            if (cell == 0)   // once per pass over the board
+            {
+                shooter = freshAttacker;
+                target = freshDefender;
+            }
+            hits += shooter.Fire(target, cell / COLS, cell % COLS).result != SHOT_MISS;
+        });
+        g_sink += hits;
+        return sample;
+    });
+
+    // Shot selection, timed call by call over whole games
+    run(options, results, label + "/ai/easy", [&](long iterations) {
+        return aiShots<BoardType, EasyStrategy<BoardType> >(options.seed, numShips, iterations);
+    });
+
+    run(options, results, label + "/ai/medium", [&](long iterations) {
+        return aiShots<BoardType, MediumStrategy<BoardType> >(options.seed, numShips, iterations);
+    });
+
+    run(options, results, label + "/ai/hard", [&](long iterations) {
+        return aiShots<BoardType, HardStrategy<BoardType> >(options.seed, numShips, iterations);
+    });
+
+    // Whole games through the engine, both sides the same AI chosen at run time, as Executive plays them
+    const char *difficulties = "EMH";
+    const char *names[] = {"easy", "medium", "hard"};
+    for (int d = 0; d < 3; d++)
+    {
+        Controller controller = controllerForDifficulty(difficulties[d]);
+        run(options, results, label + "/game/" + names[d], [&](long iterations) {
+            long rounds = 0;
+            AnyStrategy<BoardType> strategies[2];
+            Sample sample = timed(iterations, [&](long game) {
+                GameEngine<BoardType> engine(numShips, controller, controller, options.seed + game);
+                engine.placeFleet(1);
+                engine.placeFleet(2);
+                for (int side = 0; side < 2; side++)
+                {
+                    strategies[side].setController(controller);
+                    strategies[side].reset(options.seed + game, side + 1);
+                }
+                auto quiet = [](int, int, const Shot &) {};
+                while (!engine.isOver()) playTurn(engine, strategies[engine.getCurrentSide() - 1], engine.getCurrentSide(), quiet);
+                rounds += engine.getRound();
+            });
+            g_sink += rounds;
+            return sample;
+        });
+    }
+
+    NullBuffer nullBuffer;
+    ostream nullSink(&nullBuffer);
+    Display display(BoardType::checkBig(), nullSink);
+    run(options, results, label + "/display/matchFrame", [&](long iterations) {
+        return timed(iterations, [&](long) { display.matchFrame(1, attacker.enemy_ships, defender.my_ships); });
+    });
+    run(options, results, label + "/display/friendlyBoard", [&](long iterations) {
+        return timed(iterations, [&](long) { display.friendlyBoard(defender.my_ships); });
+    });
+}
+
+void printJson(const BenchOptions &options, const vector<BenchResult> &results)
+{
+    cout << "{\n  \"seed\": " << options.seed << ",\n  \"min_seconds\": " << options.minSeconds << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &result = results[i];
+        double nsPerOp = result.ops > 0 ? 1e9 * result.seconds / result.ops : 0;
+        double opsPerSec = result.seconds > 0 ? result.ops / result.seconds : 0;
+        cout << (i == 0 ? "\n" : ",\n")
+             << "    {\"name\": \"" << result.name << "\", \"ops\": " << result.ops
+             << ", \"seconds\": " << result.seconds << ", \"ns_per_op\": " << nsPerOp
+             << ", \"ops_per_sec\": " << opsPerSec << "}";
+    }
+    cout << "\n  ]\n}\n";
+}
+
+void usage()
+{
+    cerr << "usage: battleship-bench [--filter TEXT] [--min-time SECONDS] [--seed S]\n";
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc) usage();
+        string value = argv[++i];
+
+        if (arg == "--filter") options.filter = value;
+        else if (arg == "--min-time") options.minSeconds = atof(value.c_str());
+        else if (arg == "--seed") options.seed = strtoull(value.c_str(), NULL, 10);
+        else usage();
+    }
+    if (options.minSeconds <= 0) usage();
+
+    vector<BenchResult> results;
+    run(options, results, "clock/pair", [&](long iterations) {
+        double total = 0;
+        Sample sample = timed(iterations, [&](long) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            total += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        });
+        g_sink += total > 0;
+        return sample;
+    });
+    boardBenchmarks<NormalBoard>(options, results, "9x9", 5);
+    boardBenchmarks<XLBoard>(options, results, "20x20", 10);
+
+    // The 9x9/game/easy games again, BatchEngine::LANES at a time; one op is one game
+    run(options, results, "9x9/game/easy-batch", [&](long iterations) {
+        const int LANES = BatchEngine::LANES;
+        BatchEngine engine(5);
+        EasyStrategy<NormalBoard> first[LANES];
+        EasyStrategy<NormalBoard> second[LANES];
+        uint64_t seeds[LANES];
+        long shots = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long game = 0; game < iterations; game += LANES)
+        {
+            int lanes = iterations - game < LANES ? static_cast<int>(iterations - game) : LANES;
+            for (int lane = 0; lane < lanes; lane++) seeds[lane] = options.seed + game + lane;
+            playBatch(engine, seeds, lanes, first, second, [&](int, int, int, const Shot &) { shots++; });
+        }
+        Sample sample = {iterations, chrono::duration<double>(chrono::steady_clock::now() - start).count()};
+        g_sink += shots;
+        return sample;
+    });
+    printJson(options, results);
+    return 0;
+}
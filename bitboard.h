@@ -0,0 +1,243 @@
+/*------------------------------------------------------------
+ * @Filename: bitboard.h
+ * @Description: fixed-size bit set used as one layer of a board
+ ------------------------------------------------------------*/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+/**
+ * @brief A set of Bits cells packed into 64-bit words, one bit per cell.
+ *
+ * Cells are numbered row-major (row * numCols + col) by the Board that owns
+ * the mask. Bits past the end of the last word are always kept at zero so that
+ * count() and any() never see stray cells.
+ */
+template <int Bits>
+class Bitboard
+{
+    public:
+        static const int WORDS = (Bits + 63) / 64;
+
+        /**
+         * @brief Construct an empty mask
+         *
+         */
+        Bitboard() { clear(); }
+
+        /**
+         * @brief Get the mask holding every one of the Bits cells
+         *
+         * @return Bitboard The full mask
+         */
+        static Bitboard full()
+        {
+            Bitboard r;
+            for (int w = 0; w < WORDS; w++) r.m_words[w] = ~uint64_t(0);
+            r.trim();
+            return r;
+        }
+
+        /**
+         * @brief Remove every cell from the mask
+         *
+         */
+        void clear()
+        {
+            for (int w = 0; w < WORDS; w++) m_words[w] = 0;
+        }
+
+        /**
+         * @brief Add a cell to the mask
+         *
+         * @param index The cell to add
+         */
+        void set(int index) { m_words[index >> 6] |= uint64_t(1) << (index & 63); }
+
+        /**
+         * @brief Remove a cell from the mask
+         *
+         * @param index The cell to remove
+         */
+        void reset(int index) { m_words[index >> 6] &= ~(uint64_t(1) << (index & 63)); }
+
+        /**
+         * @brief Check whether a cell is in the mask
+         *
+         * @param index The cell to check
+         * @return true The cell is set
+         * @return false The cell is not set
+         */
+        bool test(int index) const { return (m_words[index >> 6] >> (index & 63)) & 1; }
+
+        /**
+         * @brief Count the cells in the mask
+         *
+         * @return int The number of set cells
+         */
+        int count() const
+        {
+            int n = 0;
+            for (int w = 0; w < WORDS; w++) n += __builtin_popcountll(m_words[w]);
+            return n;
+        }
+
+        /**
+         * @brief Check whether any cell is set
+         *
+         * @return true At least one cell is set
+         * @return false The mask is empty
+         */
+        bool any() const
+        {
+            uint64_t acc = 0;
+            for (int w = 0; w < WORDS; w++) acc |= m_words[w];
+            return acc != 0;
+        }
+
+        /**
+         * @brief Find the lowest set cell
+         *
+         * @return int The index of that cell, or -1 if the mask is empty
+         */
+        int first() const
+        {
+            for (int w = 0; w < WORDS; w++)
+            {
+                if (m_words[w]) return (w << 6) + __builtin_ctzll(m_words[w]);
+            }
+            return -1;
+        }
+
+        /**
+         * @brief Find the n-th set cell in index order
+         *
+         * @param n Which set cell to find, counting from 0; must be below count()
+         * @return int The index of that cell
+         */
+        int nth(int n) const
+        {
+            for (int w = 0; w < WORDS; w++)
+            {
+                uint64_t word = m_words[w];
+                int inWord = __builtin_popcountll(word);
+                if (n >= inWord)
+                {
+                    n -= inWord;
+                    continue;
+                }
+                for (; n > 0; n--) word &= word - 1;
+                return (w << 6) + __builtin_ctzll(word);
+            }
+            return -1;
+        }
+
+        Bitboard operator&(const Bitboard &other) const
+        {
+            Bitboard r(*this);
+            for (int w = 0; w < WORDS; w++) r.m_words[w] &= other.m_words[w];
+            return r;
+        }
+
+        Bitboard operator|(const Bitboard &other) const
+        {
+            Bitboard r(*this);
+            for (int w = 0; w < WORDS; w++) r.m_words[w] |= other.m_words[w];
+            return r;
+        }
+
+        Bitboard operator^(const Bitboard &other) const
+        {
+            Bitboard r(*this);
+            for (int w = 0; w < WORDS; w++) r.m_words[w] ^= other.m_words[w];
+            return r;
+        }
+
+        Bitboard &operator&=(const Bitboard &other)
+        {
+            for (int w = 0; w < WORDS; w++) m_words[w] &= other.m_words[w];
+            return *this;
+        }
+
+        Bitboard &operator|=(const Bitboard &other)
+        {
+            for (int w = 0; w < WORDS; w++) m_words[w] |= other.m_words[w];
+            return *this;
+        }
+
+        Bitboard &operator^=(const Bitboard &other)
+        {
+            for (int w = 0; w < WORDS; w++) m_words[w] ^= other.m_words[w];
+            return *this;
+        }
+
+        /**
+         * @brief Move every cell n places towards index 0 (cell i becomes cell i - n)
+         *
+         * @param n The distance to move, 0 or more
+         * @return Bitboard The moved mask; cells moved below 0 are dropped
+         */
+        Bitboard operator>>(int n) const
+        {
+            Bitboard r;
+            int words = n >> 6;
+            int bits = n & 63;
+            for (int w = 0; w + words < WORDS; w++)
+            {
+                uint64_t v = m_words[w + words] >> bits;
+                if (bits && w + words + 1 < WORDS) v |= m_words[w + words + 1] << (64 - bits);
+                r.m_words[w] = v;
+            }
+            return r;
+        }
+
+        /**
+         * @brief Move every cell n places away from index 0 (cell i becomes cell i + n)
+         *
+         * @param n The distance to move, 0 or more
+         * @return Bitboard The moved mask; cells moved past Bits are dropped
+         */
+        Bitboard operator<<(int n) const
+        {
+            Bitboard r;
+            int words = n >> 6;
+            int bits = n & 63;
+            for (int w = words; w < WORDS; w++)
+            {
+                uint64_t v = m_words[w - words] << bits;
+                if (bits && w - words - 1 >= 0) v |= m_words[w - words - 1] >> (64 - bits);
+                r.m_words[w] = v;
+            }
+            r.trim();
+            return r;
+        }
+
+        /**
+         * @brief The cells of this mask which are not in other
+         *
+         * @param other The cells to remove
+         * @return Bitboard this & ~other
+         */
+        Bitboard andNot(const Bitboard &other) const
+        {
+            Bitboard r(*this);
+            for (int w = 0; w < WORDS; w++) r.m_words[w] &= ~other.m_words[w];
+            return r;
+        }
+
+        uint64_t m_words[WORDS];
+
+    private:
+        /**
+         * @brief Clear the unused bits past Bits in the last word
+         *
+         */
+        void trim()
+        {
+            if (Bits % 64) m_words[WORDS - 1] &= (uint64_t(1) << (Bits % 64)) - 1;
+        }
+};
+
+#endif
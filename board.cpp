@@ -1,162 +1,111 @@
 #include "board.h"
+#include "stats.h"
 
-
-Board::Board()
+namespace
 {
-    numShips = 10;
-    for(int i=0; i<20; i++)
-    {
-        for(int j=0; j<20; j++)
-        {
-            m_boardXL[i][j] = '-';
-            m_board_shipsXL[i][j] = 0;
-        }
-    }
-    for(int i=0; i<9; i++)
+    uint64_t markKey(char mark, int index)
     {
-        for(int j=0; j<9; j++)
-        {
-            m_board[i][j] = '-';
-            m_board_ships[i][j] = 0;
-        }
+        if (mark == 'X') return Zobrist::key(Zobrist::HIT, index);
+        if (mark == 'O') return Zobrist::key(Zobrist::MISS, index);
+        return 0;
     }
 }
 
-void Board::setBig() {
-    numRows = 20;
-    numCols = 20;
+
+template <int Rows, int Cols>
+Board<Rows, Cols>::Board()
+{
+    numShips = 10;
 }
 
-Board::~Board() {}
+template <int Rows, int Cols>
+Board<Rows, Cols>::~Board() {}
 
-void Board::printBoard()
+template <int Rows, int Cols>
+void Board<Rows, Cols>::printBoard()
 {
-	int sideNum = 1;
-	for(int i=0; i<numRows; i++)
+	cout << "  ";
+	for(char c = 'A'; c <= 'A' + Cols - 1; c++)
+	{
+		cout << c << " ";
+	}
+	cout << "\n";
+
+	for(int i=0; i<Rows; i++)
 	{
-		for(int j=0; j<numCols; j++)
+		cout << i + 1 << " ";
+		for(int j=0; j<Cols; j++)
 		{
-			if(i == 0 && j == 0)
-			{
-				cout << "  ";
-				for(char c = 'A'; c <= 'A' + numCols - 1; c++)
-				{
-					cout << c << " ";
-				}
-				cout << "\n";
-			}
-			if(j == 0)
-			{
-				cout << sideNum << " ";
-			}
-			if(checkBig())
-			{
-			    cout << m_boardXL[i][j] << " ";
-			}
-			else
-			{
-				cout << m_board[i][j] << " ";
-			}
+			cout << m_layers.value(i * Cols + j) << " ";
 		}
-		sideNum++;
 		cout << "\n";
 	}
 }
 
-void Board::updateBoard(int row, int col, char c, int shipnum)
+template <int Rows, int Cols>
+void Board<Rows, Cols>::updateBoard(int row, int col, char c, int shipnum)
 {
-    if (checkBig()) {
-        if (c == 'S') {
-            m_board_shipsXL[row][col] = shipnum;
-        }
-        m_boardXL[row][col] = c;
-    } else {
-        if (c == 'S') {
-            m_board_ships[row][col] = shipnum;
-        }
-        m_board[row][col] = c;
-    }
+    int index = row * Cols + col;
+    char before = m_layers.value(index);
+    m_layers.update(index, c, shipnum);
+    char after = m_layers.value(index);
+    if (before != after) m_hash ^= markKey(before, index) ^ markKey(after, index);
 }
 
-void Board::updateNumShips(int numships)
+template <int Rows, int Cols>
+int Board<Rows, Cols>::receiveShot(int row, int col)
+{
+    int index = row * Cols + col;
+    if (m_layers.m_hits.test(index) || m_layers.m_misses.test(index)) return -1;
+    int ship = m_layers.shoot(index);
+    m_hash ^= markKey(ship != 0 ? 'X' : 'O', index);
+    return ship;
+}
+
+template <int Rows, int Cols>
+void Board<Rows, Cols>::updateNumShips(int numships)
 {
     numShips = numships;
 }
 
-char Board::getValue(int row, int col)
+template <int Rows, int Cols>
+char Board<Rows, Cols>::getValue(int row, int col)
 {
-	if (checkBig()) {
-        return m_boardXL[row][col];
-    } else {
-        return m_board[row][col];
-    }
+    return m_layers.value(row * Cols + col);
 }
 
-int Board::getShipNum(int row, int col)
+template <int Rows, int Cols>
+int Board<Rows, Cols>::getShipNum(int row, int col)
 {
-    if (checkBig()) {
-        return m_board_shipsXL[row][col];
-    } else {
-        return m_board_ships[row][col];
-    }
+    return m_layers.shipNum(row * Cols + col);
 }
 
-bool Board::shipNumIsSunk(int shipNum)
+template <int Rows, int Cols>
+bool Board<Rows, Cols>::shipNumIsSunk(int shipNum)
 {
-    for (int row=0; row < numRows; row++) {
-        for (int col=0; col < numCols; col++) {
-            if (checkBig()) {
-                if (m_board_shipsXL[row][col] == shipNum && m_boardXL[row][col] == 'S') {
-                    // Part of ship remains
-                    return false;
-                }
-            } else {
-                if (m_board_ships[row][col] == shipNum && m_board[row][col] == 'S') {
-                    // Part of ship remains
-                    return false;
-                }
-            }
-        }
+    if (shipNum < 1 || shipNum > BoardLayers<Rows * Cols>::MAX_SHIP_NUM) {
+        return true;
     }
-
-    return true;
+    return m_layers.m_remaining[shipNum] == 0;
 }
 
-bool Board::shipIsSunk(int row, int col)
+template <int Rows, int Cols>
+bool Board<Rows, Cols>::shipIsSunk(int row, int col)
 {
     return shipNumIsSunk(getShipNum(row, col));
 }
 
-bool Board::allShipsSunk()
+template <int Rows, int Cols>
+bool Board<Rows, Cols>::allShipsSunk()
 {
-    for (int shipnum = 1; shipnum <= numShips; shipnum++) {
-        if (!shipNumIsSunk(shipnum)) {
-            return false;
-        }
-    }
-    return true;
+    STATS_COUNT(ALL_SHIPS_SUNK_CALLS);
+    return m_layers.m_floating == 0;
 }
 
-int Board::getNumRows() {
-    return numRows;
-}
-
-int Board::getNumCols() {
-    return numCols;
-}
-
-int Board::getNumHits() {
-    int hits = 0;
-    for (int row=0; row < numRows; row++) {
-        for (int col=0; col < numCols; col++) {
-            if ((!checkBig() && m_board[row][col] == 'X') || (checkBig() && m_boardXL[row][col] == 'X'))  {
-                hits++;
-            }
-        }
-    }
-    return hits;
+template <int Rows, int Cols>
+int Board<Rows, Cols>::getNumHits() {
+    return m_layers.m_hits.count();
 }
 
-bool Board::checkBig() {
-    return numRows == 20;
-}
\ No newline at end of file
+template class Board<9, 9>;
+template class Board<20, 20>;
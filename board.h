@@ -2,13 +2,185 @@
 #define BOARD_H
 
 #include <iostream>
+#include <stdint.h>
+#include "bitboard.h"
 using namespace std;
 
+/**
+ * @brief Zobrist keys: a random 64-bit key per (layer, index), XORed together to hash a position
+ *
+ * The keys are mixed from the layer and index with splitmix64 rather than
+ * looked up, so every board size gets its own keys without a table to build.
+ */
+namespace Zobrist
+{
+    enum Layer
+    {
+        HIT,        // an 'X' on a cell
+        MISS,       // an 'O' on a cell
+        SUNK,       // a cell of a sunk ship
+        FLOATING    // a ship number still afloat
+    };
+
+    inline uint64_t key(int layer, int index)
+    {
+        uint64_t z = (static_cast<uint64_t>(layer) << 32 | static_cast<uint64_t>(index)) * 0x9E3779B97F4A7C15ULL + 0x2545F4914F6CDD1DULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief XOR together the keys of every cell of a mask in one layer
+     *
+     */
+    template <int Bits>
+    uint64_t keyOf(int layer, Bitboard<Bits> cells)
+    {
+        uint64_t hash = 0;
+        for (int cell = cells.first(); cell >= 0; cell = cells.first())
+        {
+            cells.reset(cell);
+            hash ^= key(layer, cell);
+        }
+        return hash;
+    }
+}
+
+/**
+ * @brief The state layers of one board size: a mask per cell state and a mask per ship
+ *
+ * A cell is 'X' if it is in m_hits, otherwise 'O' if it is in m_misses, otherwise
+ * 'S' if it is in m_ships, otherwise '-'. Hitting a ship keeps it in m_ships so the
+ * ship number can still be found.
+ *
+ * m_remaining counts the 'S' cells left for each ship number and m_floating the
+ * ships with at least one such cell, so sunk checks never scan the board.
+ */
+template <int Bits>
+struct BoardLayers
+{
+    static const int MAX_SHIP_NUM = 10;
+
+    Bitboard<Bits> m_ships;
+    Bitboard<Bits> m_hits;
+    Bitboard<Bits> m_misses;
+    Bitboard<Bits> m_shipMasks[MAX_SHIP_NUM + 1];
+    int m_remaining[MAX_SHIP_NUM + 1];
+    int m_floating;
+
+    BoardLayers() : m_floating(0)
+    {
+        for (int s = 0; s <= MAX_SHIP_NUM; s++) m_remaining[s] = 0;
+    }
+
+    void update(int index, char c, int shipnum)
+    {
+        int before = liveShip(index);
+
+        if (c == 'S') {
+            m_ships.set(index);
+            m_shipMasks[shipnum].set(index);
+            m_hits.reset(index);
+            m_misses.reset(index);
+        } else if (c == 'X') {
+            m_hits.set(index);
+            m_misses.reset(index);
+        } else if (c == 'O') {
+            m_misses.set(index);
+            m_hits.reset(index);
+        } else {
+            m_ships.reset(index);
+            m_hits.reset(index);
+            m_misses.reset(index);
+            for (int s = 0; s <= MAX_SHIP_NUM; s++) m_shipMasks[s].reset(index);
+        }
+
+        int after = liveShip(index);
+        if (before != after) {
+            if (before != 0 && --m_remaining[before] == 0) m_floating--;
+            if (after != 0 && m_remaining[after]++ == 0) m_floating++;
+        }
+    }
+
+    /**
+     * @brief Turn every cell of cells into an 'S' of ship shipnum; every cell must be '-'
+     *
+     */
+    void place(const Bitboard<Bits> &cells, int shipnum)
+    {
+        int count = cells.count();
+        if (count == 0) return;
+        m_ships |= cells;
+        m_shipMasks[shipnum] |= cells;
+        if (m_remaining[shipnum] == 0) m_floating++;
+        m_remaining[shipnum] += count;
+    }
+
+    /**
+     * @brief Mark a shot at a cell which has not been fired at
+     *
+     * @return int The number of the ship hit, or 0 for a miss
+     */
+    int shoot(int index)
+    {
+        int ship = shipNum(index);
+        if (ship == 0) {
+            m_misses.set(index);
+            return 0;
+        }
+        m_hits.set(index);
+        if (--m_remaining[ship] == 0) m_floating--;
+        return ship;
+    }
+
+    char value(int index) const
+    {
+        if (m_hits.test(index)) return 'X';
+        if (m_misses.test(index)) return 'O';
+        if (m_ships.test(index)) return 'S';
+        return '-';
+    }
+
+    int shipNum(int index) const
+    {
+        if (!m_ships.test(index)) return 0;
+        for (int s = 1; s <= MAX_SHIP_NUM; s++) {
+            if (m_shipMasks[s].test(index)) return s;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief The ship number of an 'S' cell, or 0 if the cell is not an 'S'
+     *
+     */
+    int liveShip(int index) const
+    {
+        if (m_hits.test(index) || m_misses.test(index)) return 0;
+        return shipNum(index);
+    }
+};
+
+/**
+ * @brief A Rows x Cols battleship grid
+ *
+ * The dimensions are template parameters so each game only stores the grid it
+ * plays on and every row/column loop has constant bounds. NormalBoard and
+ * XLBoard are explicitly instantiated in board.cpp.
+ */
+template <int Rows, int Cols>
 class Board
 {
 	public:
+        static const int ROWS = Rows;
+        static const int COLS = Cols;  // Letters (A-I or A-T)
+        static const int CELLS = Rows * Cols;
+
+        typedef Bitboard<Rows * Cols> Mask;   // one bit per cell, row * COLS + col
+
 		/**
- 		* @breif: initializes a blank 9x9 board and a 20x20 board with '-' values
+ 		* @breif: initializes a blank board with '-' values
  		**/
 		Board();
         /** 
@@ -16,12 +188,6 @@ class Board
         **/
 		~Board();
 
-        /**
-         * @brief Set the board size to big
-         * 
-         */
-        void setBig();
-
 		/**
  		* @post: prints the board characters
 		**/
@@ -37,6 +203,23 @@ class Board
          */
 		void updateBoard(int row, int col, char c, int shipsize=0);
 
+        /**
+         * @brief Place a whole ship at once
+         * 
+         * @param cells The ship's cells, all of which must be '-'
+         * @param shipNum The ship number, 1 to 10
+         */
+        void placeShip(const Mask &cells, int shipNum) { m_layers.place(cells, shipNum); }
+
+        /**
+         * @brief Take a shot: mark the cell 'X' if a ship is there, 'O' if not
+         * 
+         * @param row The row fired at
+         * @param col The column fired at
+         * @return int The number of the ship hit, 0 for a miss, or -1 if the cell was already fired at (nothing changes)
+         */
+        int receiveShot(int row, int col);
+
 
         /**
          * @brief Update the number of ships which are on this board
@@ -60,7 +243,7 @@ class Board
          * @return true The board is size XL
          * @return false The board is not size XL
          */
-        bool checkBig();
+        static bool checkBig() { return Rows == 20; }
         /**
          * @brief Get the Ship Num at the given coordinates
          * 
@@ -94,22 +277,18 @@ class Board
          */
         bool allShipsSunk();
 
-		char m_board[9][9];
-		char m_boardXL[20][20];
-		int m_board_ships[9][9];
-		int m_board_shipsXL[20][20];
         /**
          * @brief Get the number of rows
          * 
          * @return int The number of rows
          */
-        int getNumRows();
+        static int getNumRows() { return Rows; }
         /**
          * @brief Get the number of columns
          * 
          * @return int The number of columns
          */
-        int getNumCols();
+        static int getNumCols() { return Cols; }
 
         /**
          * @brief Get the number of hits on the board
@@ -118,11 +297,64 @@ class Board
          */
         int getNumHits();
 
+        /**
+         * @brief Get the number of ships on this board
+         * 
+         * @return int The number of ships, numbered 1 to getNumShips()
+         */
+        int getNumShips() { return numShips; }
+
+        /**
+         * @brief Get the cells marked 'X'
+         * 
+         * @return const Mask& The hit cells
+         */
+        const Mask &getHitMask() const { return m_layers.m_hits; }
+
+        /**
+         * @brief Get the cells marked 'O'
+         * 
+         * @return const Mask& The missed cells
+         */
+        const Mask &getMissMask() const { return m_layers.m_misses; }
+
+        /**
+         * @brief Get every cell of one ship, hit or not
+         * 
+         * @param shipNum The ship number, 1 to 10
+         * @return const Mask& The ship's cells
+         */
+        const Mask &getShipMask(int shipNum) const { return m_layers.m_shipMasks[shipNum]; }
+
+        /**
+         * @brief Get every cell which is not '-'
+         * 
+         * @return Mask The ship, hit and missed cells
+         */
+        Mask getOccupiedMask() const { return m_layers.m_ships | m_layers.m_hits | m_layers.m_misses; }
+
+        /**
+         * @brief Get the Zobrist hash of the 'X' and 'O' marks, kept up to date by updateBoard
+         * 
+         * Two boards with the same hits and misses have the same hash, whatever
+         * their ships and whatever order the shots came in.
+         * 
+         * @return uint64_t The hash; 0 for a board with no marks
+         */
+        uint64_t getHash() const { return m_hash; }
+
 	private:
-		int numRows = 9;
-		int numCols = 9;  // Letters (A-I)
+        BoardLayers<Rows * Cols> m_layers;
+        uint64_t m_hash = 0;
+
         int numShips = 5;
 };
 
+typedef Board<9, 9> NormalBoard;
+typedef Board<20, 20> XLBoard;
+
+extern template class Board<9, 9>;
+extern template class Board<20, 20>;
+
 
 #endif
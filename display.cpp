@@ -1,9 +1,11 @@
 #include "display.h"
 #include <iostream>
+#include <unistd.h>
+#include <sys/ioctl.h>
 
 using namespace std;
 
-Display::Display(bool big)
+Display::Display(bool big, ostream &out) : m_out(out)
 {
 	if(big){
 		m_borderSpace = "\n\n";
@@ -37,128 +39,318 @@ Display::Display(bool big)
 	m_hit5 = "          ,,.'` _,'       `'.,,\n\n\n";
 	m_miss = "\n\n                   MISS...\n\n\n";
 
+	//every row label once, so drawing a row copies it instead of formatting it
+	int numRows = big ? 20 : 9;
+	for(int i = 0; i < numRows; i++)
+	{
+		string rowiLabel = m_rowiLabel;
+		rowiLabel.replace(2, i > 8 ? 2 : 1, to_string(i+1));
+		m_rowLabels.push_back(rowiLabel);
+	}
+
+	//room for a whole match frame: two boards with their banners and spacing
+	m_width = static_cast<int>(max(m_borderLineTop.size(), m_colLabel.size()));
+	m_maxLines = 2 * (2 * numRows + 16);
+	m_frame.assign(m_width * m_maxLines, ' ');
+	m_shown.assign(m_width * m_maxLines, ' ');
+	m_output.reserve(2 * m_frame.size());
+	m_line = 0;
+	m_col = 0;
+	m_shownLines = 0;
+	m_shownEndLine = 0;
+	m_shownEndCol = 0;
+	m_ansi = &out == &cout && isatty(STDOUT_FILENO);
 }
 
+
 Display::~Display()
 {}
 
-void Display::matchFrame(int playerID, Board &enemyBrd, Board &friendlyBrd) const
+void Display::beginFrame()
 {
-	enemyBoard(enemyBrd, playerID);
-	cout << m_borderSpace;
-	friendlyBoard(friendlyBrd);
+	fill(m_frame.begin(), m_frame.end(), ' ');
+	m_line = 0;
+	m_col = 0;
 }
 
-void Display::enemyBoard(Board &board, int playerID) const
+void Display::put(int line, int col, char c)
 {
-	string playeriBanner = m_playeriBanner;
-	string enemyBanner = m_enemyBanner;
-	string rowiLabel = m_rowiLabel;
+	if(line < m_maxLines && col < m_width)
+	{
+		m_frame[line * m_width + col] = c;
+	}
+}
 
-	playeriBanner.replace(24, 1, to_string(playerID));
+void Display::addText(const string &text)
+{
+	for(size_t i = 0; i < text.size(); i++)
+	{
+		if(text[i] == '\n')
+		{
+			m_line++;
+			m_col = 0;
+		}
+		else
+		{
+			put(m_line, m_col++, text[i]);
+		}
+	}
+}
 
-	cout << m_borderSpace;
-	cout << playeriBanner;
-	cout << enemyBanner;
-	cout << m_colLabel;
-	cout << m_borderLineTop;
+bool Display::fits(int lines) const
+{
+	struct winsize size;
+	if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0)
+	{
+		return false;
+	}
+	return lines + PROMPT_LINES <= size.ws_row;
+}
+
+void Display::present()
+{
+	int lines = min(m_line + (m_col > 0 ? 1 : 0), m_maxLines);
+	m_output.clear();
+
+	if(m_ansi && m_shownLines > 0 && fits(max(lines, m_shownLines)))
+	{
+		//the last frame is still at the top of the screen: wipe what was printed under it, then rewrite only the runs of changed cells
+		m_output += "\x1b[" + to_string(m_shownEndLine + 1) + ";" + to_string(m_shownEndCol + 1) + "H\x1b[J";
+		for(int i = 0; i < max(lines, m_shownLines); i++)
+		{
+			const char *now = &m_frame[i * m_width];
+			const char *was = &m_shown[i * m_width];
+			int j = 0;
+			while(j < m_width)
+			{
+				if(now[j] == was[j])
+				{
+					j++;
+					continue;
+				}
+				//a gap of a few unchanged cells is cheaper to resend than to jump over
+				int end = j + 1;
+				for(int k = end; k < m_width && k < end + 8; k++)
+				{
+					if(now[k] != was[k]) end = k + 1;
+				}
+				m_output += "\x1b[" + to_string(i + 1) + ";" + to_string(j + 1) + "H";
+				m_output.append(now + j, end - j);
+				j = end;
+			}
+		}
+		//leave the cursor where streaming the frame would have
+		m_output += "\x1b[" + to_string(m_line + 1) + ";" + to_string(m_col + 1) + "H";
+	}
+	else
+	{
+		if(m_ansi) m_output += "\x1b[H\x1b[2J";
+		for(int i = 0; i < lines; i++)
+		{
+			const char *now = &m_frame[i * m_width];
+			int length = m_width;
+			while(length > 0 && now[length - 1] == ' ') length--;
+			m_output.append(now, length);
+			if(i < m_line) m_output += '\n';
+		}
+	}
+
+	m_out.write(m_output.data(), m_output.size());
+	m_out.flush();
+
+	swap(m_frame, m_shown);
+	m_shownLines = lines;
+	m_shownEndLine = m_line;
+	m_shownEndCol = m_col;
+}
+
+void Display::clear()
+{
+	if(!m_ansi)
+	{
+		m_out << '\n';
+	}
+	else if(m_shownLines > 0 && fits(m_shownLines))
+	{
+		m_out << "\x1b[" << m_shownEndLine + 1 << ";" << m_shownEndCol + 1 << "H\x1b[J";
+	}
+	else
+	{
+		m_out << "\x1b[H\x1b[2J";
+		m_shownLines = 0;
+	}
+	m_out.flush();
+}
+
+template <class BoardType>
+void Display::matchFrame(int playerID, BoardType &enemyBrd, BoardType &friendlyBrd)
+{
+	beginFrame();
+	drawEnemy(enemyBrd, playerID);
+	addText(m_borderSpace);
+	drawFriendly(friendlyBrd);
+	present();
+}
+
+template <class BoardType>
+void Display::enemyBoard(BoardType &board, int playerID)
+{
+	beginFrame();
+	drawEnemy(board, playerID);
+	present();
+}
+
+template <class BoardType>
+void Display::friendlyBoard(BoardType &board)
+{
+	beginFrame();
+	drawFriendly(board);
+	present();
+}
+
+template <class BoardType>
+void Display::drawEnemy(BoardType &board, int playerID)
+{
+	addText(m_borderSpace);
+	addText(m_playeriBanner);
+	put(m_line - 3, 24, '0' + playerID);
+	addText(m_enemyBanner);
+	addText(m_colLabel);
+	addText(m_borderLineTop);
 
 	for(int i = 0; i < board.getNumRows(); i++)
 	{
-        int numChars = 1;
-        if (i > 8) {
-            numChars = 2;
-        }
-		rowiLabel.replace(2, numChars, to_string(i+1));
+		int line = m_line;
+		addText(m_rowLabels[i]);
 
 		for(int j = 0; j < board.getNumCols(); j++)
 		{
-			if(board.getValue(i, j) == 'X')
-			{
-				rowiLabel.replace(4*j+7, 1, "X");
-			}
-			else if(board.getValue(i, j) == 'O')
+			char value = board.getValue(i, j);
+			if(value == 'X' || value == 'O')
 			{
-				rowiLabel.replace(4*j+7, 1, "O");
+				put(line, 4*j+7, value);
 			}
 		}
 
-		cout << rowiLabel;
-		rowiLabel = m_rowiLabel;
-
 		if(i < board.getNumRows() - 1)
 		{
-			cout << m_gridLine;
+			addText(m_gridLine);
 		}
 		else
 		{
-			cout << m_borderLineBottom;
+			addText(m_borderLineBottom);
 		}
 	}
 }
 
-void Display::friendlyBoard(Board &board) const
+template <class BoardType>
+void Display::drawFriendly(BoardType &board)
 {
-	string rowiLabel = m_rowiLabel;
-
-	cout << m_friendlyBanner;
-	cout << m_colLabel;
-	cout << m_borderLineTop;
+	addText(m_friendlyBanner);
+	addText(m_colLabel);
+	addText(m_borderLineTop);
 
 	for(int i = 0; i < board.getNumRows(); i++)
 	{
-        int numChars = 1;
-        if (i > 8) {
-            numChars = 2;
-        }
-		rowiLabel.replace(2, numChars, to_string(i+1));
+		int line = m_line;
+		addText(m_rowLabels[i]);
 
 		for(int j = 0; j < board.getNumCols(); j++)
 		{
-			if(board.getValue(i, j) == 'X')
+			char value = board.getValue(i, j);
+			if(value == 'X')
 			{
-				rowiLabel.replace(4*j+6, 1, ">");
-				rowiLabel.replace(4*j+7, 1, string(1, '0' + board.getShipNum(i, j)));
-				rowiLabel.replace(4*j+8, 1, "<");
+				put(line, 4*j+6, '>');
+				put(line, 4*j+7, '0' + board.getShipNum(i, j));
+				put(line, 4*j+8, '<');
 			}
-			else if(board.getValue(i, j) == 'S')
+			else if(value == 'S')
 			{
-				rowiLabel.replace(4*j+6, 1, "(");
-                rowiLabel.replace(4*j+7, 1, string(1, '0' + board.getShipNum(i, j)));
-				rowiLabel.replace(4*j+8, 1, ")");
+				put(line, 4*j+6, '(');
+				put(line, 4*j+7, '0' + board.getShipNum(i, j));
+				put(line, 4*j+8, ')');
 			}
-			else if(board.getValue(i, j) == 'O')
+			else if(value == 'O')
 			{
-				rowiLabel.replace(4*j+7, 1, "O");
+				put(line, 4*j+7, 'O');
 			}
 		}
 
-		cout << rowiLabel;
-		rowiLabel = m_rowiLabel;
-
 		if(i < board.getNumRows() - 1)
 		{
-			cout << m_gridLine;
+			addText(m_gridLine);
 		}
 		else
 		{
-			cout << m_borderLineBottom;
+			addText(m_borderLineBottom);
 		}
 	}
-	cout << m_borderSpace;
+	addText(m_borderSpace);
+}
+
+template <class BoardType>
+void Display::shapeOptions(const ShipShape<BoardType> *shapes[], int count) const
+{
+	int height = 0;
+	for(int s = 0; s < count; s++)
+	{
+		if(shapes[s]->getHeight() > height) height = shapes[s]->getHeight();
+	}
+
+	string labels = "\n";
+	for(int s = 0; s < count; s++)
+	{
+		string label = "    " + to_string(s + 1) + ")";
+		label.resize(2 * shapes[s]->getWidth() + 6, ' ');
+		labels += label;
+	}
+	m_out << labels << "\n";
+
+	for(int i = 0; i < height; i++)
+	{
+		string line;
+		for(int s = 0; s < count; s++)
+		{
+			line += "    ";
+			for(int j = 0; j < shapes[s]->getWidth(); j++)
+			{
+				if(i < shapes[s]->getHeight() && shapes[s]->covers(i, j))
+				{
+					bool pivot = i == shapes[s]->getPivotRow() && j == shapes[s]->getPivotCol();
+					line += pivot ? "P " : "# ";
+				}
+				else
+				{
+					line += "  ";
+				}
+			}
+			line += "  ";
+		}
+		m_out << line << "\n";
+	}
+	m_out << "\n";
 }
 
 void Display::hit() const
 {
-	cout << m_hit0;
-	cout << m_hit1;
-	cout << m_hit2;
-	cout << m_hit3;
-	cout << m_hit4;
-	cout << m_hit5;
+	m_out << m_hit0;
+	m_out << m_hit1;
+	m_out << m_hit2;
+	m_out << m_hit3;
+	m_out << m_hit4;
+	m_out << m_hit5;
 }
 
 void Display::miss() const
 {
-	cout << m_miss;
+	m_out << m_miss;
 }
+
+template void Display::matchFrame<NormalBoard>(int, NormalBoard &, NormalBoard &);
+template void Display::matchFrame<XLBoard>(int, XLBoard &, XLBoard &);
+template void Display::enemyBoard<NormalBoard>(NormalBoard &, int);
+template void Display::enemyBoard<XLBoard>(XLBoard &, int);
+template void Display::friendlyBoard<NormalBoard>(NormalBoard &);
+template void Display::friendlyBoard<XLBoard>(XLBoard &);
+template void Display::shapeOptions<NormalBoard>(const ShipShape<NormalBoard> *[], int) const;
+template void Display::shapeOptions<XLBoard>(const ShipShape<XLBoard> *[], int) const;
@@ -7,10 +7,23 @@
 #define DISPLAY_H
 
 #include <string>
+#include <vector>
+#include <iostream>
 #include "board.h"
+#include "placement.h"
 
 using namespace std;
 
+/**
+ * @brief Draws the boards and the shot feed-back
+ *
+ * Boards are rendered into a frame buffer, one fixed-width line per screen
+ * row, and written to the output in a single write. On a terminal the frame is
+ * drawn from the top-left corner, and the next frame only sends ANSI cursor
+ * moves and the cells which changed since the last one. That needs the last
+ * frame still to be on the screen, so a frame too tall to stay there with room
+ * for the prompts below it is redrawn in full.
+ */
 class Display
 {
 	private:
@@ -24,6 +37,7 @@ class Display
         string m_gridLine;
         string m_borderLineBottom;
         string m_friendlyBanner;
+        vector<string> m_rowLabels; // m_rowiLabel with each row's number filled in
 
         //shot feed-back elements
         string m_hit0;
@@ -34,6 +48,62 @@ class Display
         string m_hit5;
         string m_miss;
 
+        //frame buffers, m_width characters per line
+        ostream &m_out;
+        bool m_ansi;        // m_out is a terminal which takes escape sequences
+        int m_width;
+        int m_maxLines;
+        string m_frame;     // the frame being drawn
+        string m_shown;     // the frame on the screen, if m_shownLines > 0
+        string m_output;    // the bytes of one write
+        int m_line;         // where the next character of the frame goes
+        int m_col;
+        int m_shownLines;
+        int m_shownEndLine; // where the cursor was left after the frame on the screen
+        int m_shownEndCol;
+
+        static const int PROMPT_LINES = 16; // room to leave below a frame for prompts and feed-back
+
+        /**
+         * @brief Start a new, blank frame
+         * 
+         */
+        void beginFrame();
+
+        /**
+         * @brief Add text to the frame as if streaming it, a newline starting the next line
+         * 
+         * @param text The text
+         */
+        void addText(const string &text);
+
+        /**
+         * @brief Put one character of the frame
+         * 
+         * @param line The line of the frame
+         * @param col The column of the frame
+         * @param c The character
+         */
+        void put(int line, int col, char c);
+
+        /**
+         * @brief Write the frame: the changes since the last frame if it is still on the screen, else all of it
+         * 
+         */
+        void present();
+
+        /**
+         * @brief Check whether a frame of some height leaves room for the prompts on the terminal
+         * 
+         */
+        bool fits(int lines) const;
+
+        template <class BoardType>
+        void drawEnemy(BoardType &board, int playerID);
+
+        template <class BoardType>
+        void drawFriendly(BoardType &board);
+
 	public:
 
         /**
@@ -42,30 +112,53 @@ class Display
          * @param board The board to display
          * @param playerID The player to display
          */
-        void enemyBoard(Board &board, int playerID) const;
+        template <class BoardType>
+        void enemyBoard(BoardType &board, int playerID);
 
         /**
          * @brief Construct a new Display
          * 
          * @param big The user has requested an XL board
+         * @param out Where to write; escape sequences are only used if this is cout on a terminal
          */
-        Display(bool big);
+        Display(bool big, ostream &out = cout);
 
         /**
          * @brief Display the player's ships and the enemy's shots
          * 
          * @param board The board to display
          */
-        void friendlyBoard(Board &board) const;
+        template <class BoardType>
+        void friendlyBoard(BoardType &board);
 
         /**
-         * @brief Call both the friendlyBoard and the enemyBoard methods to display the current game state 
+         * @brief Call both the friendlyBoard and the enemyBoard methods to display the current game state
          * 
          * @param playerID The current player's ID
          * @param enemyBrd The enemy player's board
          * @param friendlyBrd The current player's board
          */
-        void matchFrame(int playerID, Board &enemyBrd, Board &friendlyBrd) const;
+        template <class BoardType>
+        void matchFrame(int playerID, BoardType &enemyBrd, BoardType &friendlyBrd);
+
+        /**
+         * @brief Display the shapes a bent ship can take, side by side and numbered from 1
+         * 
+         * The pivot of each shape is marked P.
+         * 
+         * @param shapes The shapes to show
+         * @param count The number of shapes
+         */
+        template <class BoardType>
+        void shapeOptions(const ShipShape<BoardType> *shapes[], int count) const;
+
+        /**
+         * @brief Clear what was printed since the last frame, or the whole screen if that frame is gone
+         * 
+         * One escape sequence on a terminal; the next frame is then drawn over
+         * whatever of the last one is left.
+         */
+        void clear();
 
         /**
          * @brief Display the hit message
@@ -84,7 +177,7 @@ class Display
          * 
          */
         ~Display();
- 
+
 
 };
 #endif
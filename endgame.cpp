@@ -0,0 +1,284 @@
+#include "endgame.h"
+#include "stats.h"
+
+namespace
+{
+    int popcount(uint64_t bits) { return __builtin_popcountll(bits); }
+
+    template <int Bits>
+    bool sameCells(const Bitboard<Bits> &a, const Bitboard<Bits> &b) { return !(a ^ b).any(); }
+}
+
+template <class BoardType>
+Endgame<BoardType>::Endgame()
+    : m_numLayouts(0), m_lengths(0), m_numFloating(0), m_listed(0),
+      m_nodes(0), m_aborted(false), m_lastExpected(0)
+{
+    for (int length = 0; length <= MAX_SHIP_NUM; length++)
+    {
+        m_numShapes[length] = ShipShape<BoardType>::variants(length, m_shapes[length]);
+    }
+}
+
+template <class BoardType>
+void Endgame<BoardType>::clear() { m_memo.clear(); }
+
+template <class BoardType>
+bool Endgame<BoardType>::list(const Mask &free, const Mask &uncovered, unsigned placed, Layout &layout)
+{
+    if (++m_listed > LISTING_BUDGET) return false;
+
+    // Cover the lowest open hit with any unplaced ship through it
+    if (uncovered.any())
+    {
+        int hit = uncovered.first();
+        for (int ship = 0; ship < m_numFloating; ship++)
+        {
+            if (placed & (1u << ship)) continue;
+            int length = m_lengths[ship];
+            for (int v = 0; v < m_numShapes[length]; v++)
+            {
+                const ShipShape<BoardType> *shape = m_shapes[length][v];
+                for (int k = 0; k < shape->getNumCells(); k++)
+                {
+                    int corner;
+                    if (!shape->cornerFor(hit, k, corner)) continue;
+                    Mask cells = shape->cellsAt(corner);
+                    // A floating ship cannot be hit on every cell
+                    if (cells.andNot(free).any() || !cells.andNot(m_hits).any()) continue;
+                    layout.ships[ship] = cells;
+                    if (!list(free.andNot(cells), uncovered.andNot(cells), placed | (1u << ship), layout)) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Then the other ships in order, on what is left
+    int ship = 0;
+    while (ship < m_numFloating && (placed & (1u << ship))) ship++;
+    if (ship == m_numFloating)
+    {
+        if (m_numLayouts == MAX_LAYOUTS) return false;
+        Layout &done = m_layouts[m_numLayouts++];
+        done = layout;
+        done.cells.clear();
+        for (int i = 0; i < m_numFloating; i++)
+        {
+            done.cells |= done.ships[i];
+            Mask cells = done.ships[i];
+            for (int cell = cells.first(); cell >= 0; cell = cells.first())
+            {
+                cells.reset(cell);
+                done.shipAt[cell] = i;
+            }
+            done.sunkKeys[i] = Zobrist::key(Zobrist::FLOATING, m_lengths[i]) ^ Zobrist::keyOf(Zobrist::SUNK, done.ships[i]);
+        }
+        return true;
+    }
+
+    int length = m_lengths[ship];
+    for (int v = 0; v < m_numShapes[length]; v++)
+    {
+        const ShipShape<BoardType> *shape = m_shapes[length][v];
+        Mask corners = shape->legalCorners(free);
+        for (int corner = corners.first(); corner >= 0; corner = corners.first())
+        {
+            corners.reset(corner);
+            Mask cells = shape->cellsAt(corner);
+            layout.ships[ship] = cells;
+            if (!list(free.andNot(cells), uncovered, placed | (1u << ship), layout)) return false;
+        }
+    }
+    return true;
+}
+
+template <class BoardType>
+double Endgame<BoardType>::search(uint64_t subset, const Mask &fired, uint64_t key, double cutoff, int &bestCell)
+{
+    const int numLayouts = popcount(subset);
+    int left[MAX_LAYOUTS];           // unfired cells of each layout
+    int counts[BoardType::CELLS] = {0};   // layouts on each cell
+    int mostLikely = 0;
+    Mask all;
+    double total = 0;
+    for (uint64_t rest = subset; rest; rest &= rest - 1)
+    {
+        int i = __builtin_ctzll(rest);
+        Mask cells = m_layouts[i].cells.andNot(fired);
+        left[i] = cells.count();
+        total += left[i];
+        all |= cells;
+        for (int cell = cells.first(); cell >= 0; cell = cells.first())
+        {
+            cells.reset(cell);
+            if (++counts[cell] > mostLikely) mostLikely = counts[cell];
+        }
+    }
+
+    bestCell = -1;
+    if (numLayouts == 1)
+    {
+        bestCell = all.first();
+        return total;
+    }
+    // Every unfired cell of the fleet must be fired, and unless some cell is in
+    // every layout the next shot misses at least as often as the likeliest cell does
+    double bound = (total + numLayouts - mostLikely) / numLayouts;
+    if (bound >= cutoff) return bound;
+
+    typename std::unordered_map<uint64_t, Solved>::const_iterator found = m_memo.find(key);
+    if (found != m_memo.end())
+    {
+        if (found->second.cell >= 0)
+        {
+            bestCell = found->second.cell;
+            return found->second.value;
+        }
+        if (found->second.value >= cutoff) return found->second.value;
+    }
+    if (++m_nodes > SEARCH_BUDGET)
+    {
+        m_aborted = true;
+        return cutoff;
+    }
+
+    // A cell in every layout is fired first; otherwise try the cells in the most layouts first
+    int candidates[BoardType::CELLS];
+    int numCandidates = 0;
+    Mask cells = all;
+    for (int cell = cells.first(); cell >= 0; cell = cells.first())
+    {
+        cells.reset(cell);
+        if (counts[cell] == numLayouts)
+        {
+            candidates[0] = cell;
+            numCandidates = 1;
+            break;
+        }
+        int at = numCandidates++;
+        while (at > 0 && counts[candidates[at - 1]] < counts[cell])
+        {
+            candidates[at] = candidates[at - 1];
+            at--;
+        }
+        candidates[at] = cell;
+    }
+
+    struct Group
+    {
+        uint64_t members;
+        int outcome;       // 0 miss, 1 hit, 2 + ship sunk, -1 the last ship sunk
+        Mask sunk;         // the sunk ship's cells
+        uint64_t key;
+        double bound;      // the sum of the members' unfired cells after the shot
+    };
+
+    double best = cutoff;
+    for (int c = 0; c < numCandidates; c++)
+    {
+        const int cell = candidates[c];
+        // Each layout loses a cell to fire if the shot hits it; the candidates
+        // come likeliest first, so once one cannot win no later one can
+        if (1 + (total - counts[cell]) / numLayouts >= best) break;
+
+        Mask after = fired;
+        after.set(cell);
+
+        // Split the layouts by what the game would answer
+        Group groups[MAX_LAYOUTS];
+        int numGroups = 0;
+        for (uint64_t rest = subset; rest; rest &= rest - 1)
+        {
+            int i = __builtin_ctzll(rest);
+            const Layout &layout = m_layouts[i];
+            int outcome = 0;
+            Mask sunk;
+            uint64_t childKey = key ^ Zobrist::key(Zobrist::MISS, cell);
+            if (layout.cells.test(cell))
+            {
+                childKey = key ^ Zobrist::key(Zobrist::HIT, cell);
+                outcome = 1;
+                int ship = layout.shipAt[cell];
+                if (!layout.ships[ship].andNot(after).any())
+                {
+                    outcome = left[i] == 1 ? -1 : 2 + ship;
+                    sunk = layout.ships[ship];
+                    childKey ^= layout.sunkKeys[ship];
+                }
+            }
+
+            int g = 0;
+            while (g < numGroups && (groups[g].outcome != outcome || (outcome >= 2 && !sameCells(groups[g].sunk, sunk)))) g++;
+            if (g == numGroups)
+            {
+                numGroups++;
+                groups[g].members = 0;
+                groups[g].outcome = outcome;
+                groups[g].sunk = sunk;
+                groups[g].key = childKey;
+                groups[g].bound = 0;
+            }
+            groups[g].members |= uint64_t(1) << i;
+            groups[g].bound += left[i] - (outcome == 0 ? 0 : 1);
+        }
+
+        double rest = (total - counts[cell]) / numLayouts;
+        double value = 1;
+        bool pruned = false;
+        for (int g = 0; g < numGroups && !pruned; g++)
+        {
+            double p = static_cast<double>(popcount(groups[g].members)) / numLayouts;
+            rest -= groups[g].bound / numLayouts;
+            if (groups[g].outcome < 0) continue;
+
+            int childCell;
+            double expected = search(groups[g].members, after, groups[g].key, (best - value - rest) / p, childCell);
+            if (m_aborted) return cutoff;
+            value += p * expected;
+            pruned = value + rest >= best;
+        }
+        if (!pruned && value < best)
+        {
+            best = value;
+            bestCell = cell;
+        }
+    }
+
+    // Nothing beat the cutoff, so it is a lower bound worth keeping for the next search with a looser one
+    if (m_memo.size() >= static_cast<size_t>(MAX_MEMO)) m_memo.clear();
+    Solved solved = {best, bestCell};
+    m_memo[key] = solved;
+    return best;
+}
+
+template <class BoardType>
+bool Endgame<BoardType>::solve(const Mask &free, const Mask &hits, const Mask &untried, const int lengths[], int numFloating,
+                               uint64_t key, int &cell)
+{
+    if (numFloating == 0) return false;
+
+    m_lengths = lengths;
+    m_numFloating = numFloating;
+    m_hits = hits;
+    m_numLayouts = 0;
+    m_listed = 0;
+    Layout layout;
+    if (!list(free, hits, 0, layout) || m_numLayouts == 0) return false;
+
+    uint64_t subset = m_numLayouts == 64 ? ~uint64_t(0) : (uint64_t(1) << m_numLayouts) - 1;
+    m_nodes = 0;
+    m_aborted = false;
+    int bestCell;
+    double expected = search(subset, Mask::full().andNot(untried), key, BoardType::CELLS + 1.0, bestCell);
+    STATS_COUNT(ENDGAME_SEARCHES);
+    STATS_ADD(ENDGAME_NODES, m_nodes);
+    if (m_aborted || bestCell < 0) return false;
+
+    m_lastExpected = expected;
+    cell = bestCell;
+    return true;
+}
+
+template class Endgame<NormalBoard>;
+template class Endgame<XLBoard>;
@@ -0,0 +1,140 @@
+/*------------------------------------------------------------
+ * @Filename: endgame.h
+ * @Description: exact minimum-expected-shots search once few enemy fleets remain possible
+ ------------------------------------------------------------*/
+
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+#include "board.h"
+#include "placement.h"
+#include <stdint.h>
+#include <unordered_map>
+
+/**
+ * @brief Finds the shot which sinks the rest of the enemy fleet in the fewest shots on average
+ *
+ * First every fleet consistent with the attacker's view is listed (the
+ * floating ships on free cells, every open hit covered, no floating ship on
+ * hits only), each once, in the order Expert::sampleFleet would build them.
+ * If there are at most MAX_LAYOUTS of them, all equally likely, the search
+ * tries each cell at least one of them occupies. A shot splits the fleets by
+ * what the game would answer (miss, hit, which ship sank and where, or the
+ * last ship sank), and the expected number of shots is one plus the
+ * probability-weighted expectation of each part, minimised over the cells.
+ *
+ * The search is cut down three ways. A cell every remaining fleet occupies
+ * must be fired at some time, so firing it first is as good as anything
+ * else and no other cell is tried. No fleet can be finished in fewer shots
+ * than it has unfired cells, so the average of those is a lower bound, and a
+ * cell whose bound can no longer beat the best found is skipped. Positions
+ * are memoised by their positionKey, the hash of the view they stand for,
+ * so a position reached by different shot orders, or met again on a later
+ * turn, is solved once; one which could not beat its cutoff keeps that as a
+ * lower bound for the next search to reach it.
+ *
+ * Listing and searching each stop at a node budget, so a call costs at most
+ * a bounded amount of work; if either runs out, solve() reports failure and
+ * the caller falls back to its own choice.
+ */
+template <class BoardType>
+class Endgame
+{
+    public:
+        typedef typename BoardType::Mask Mask;
+
+        static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+        static const int MAX_LAYOUTS = 16;             // few enough to search; a subset holds one bit each
+        static const int LISTING_BUDGET = 4096;        // placements tried while listing the fleets
+        static const int SEARCH_BUDGET = 2000;         // positions expanded per search
+        static const int MAX_MEMO = 1 << 16;
+
+        Endgame();
+
+        /**
+         * @brief Forget every solved position
+         *
+         */
+        void clear();
+
+        /**
+         * @brief Find the best shot, if the position is small enough to solve exactly
+         *
+         * @param free The cells a floating ship may occupy: not a miss, not a sunk ship
+         * @param hits The hits not on a sunk ship
+         * @param untried The cells not fired at yet
+         * @param lengths The floating ships, longest first
+         * @param numFloating The number of floating ships
+         * @param key The position's positionKey
+         * @param cell Set to the shot
+         * @return true The position was solved
+         * @return false There are too many fleets, or the budget ran out; cell is unchanged
+         */
+        bool solve(const Mask &free, const Mask &hits, const Mask &untried, const int lengths[], int numFloating,
+                   uint64_t key, int &cell);
+
+        /**
+         * @brief Get the expected number of shots left, including the shot chosen, after the last successful solve()
+         *
+         */
+        double getLastExpected() const { return m_lastExpected; }
+
+    private:
+        /**
+         * @brief One consistent fleet: the cells of each floating ship, in the order of lengths
+         *
+         */
+        struct Layout
+        {
+            Mask cells;
+            Mask ships[MAX_SHIP_NUM];
+            signed char shipAt[BoardType::CELLS];  // which of ships covers each of cells
+            uint64_t sunkKeys[MAX_SHIP_NUM];   // what each ship's sinking adds to the position key
+        };
+
+        struct Solved
+        {
+            double value;   // the expected number of shots, or a lower bound if cell is -1
+            int cell;
+        };
+
+        /**
+         * @brief List the fleets, covering the lowest uncovered hit first and then placing the other ships in order
+         *
+         * @return true Every fleet was listed
+         * @return false There are more than MAX_LAYOUTS, or the listing budget ran out
+         */
+        bool list(const Mask &free, const Mask &uncovered, unsigned placed, Layout &layout);
+
+        /**
+         * @brief Solve a set of fleets after some cells have been fired at
+         *
+         * @param subset The fleets, one bit per layout
+         * @param fired The cells fired at
+         * @param key The position's key
+         * @param cutoff Only a value below this is of any use
+         * @param bestCell Set to the best shot if the value returned is below cutoff
+         * @return double The expected number of shots if below cutoff, else a value at least cutoff
+         */
+        double search(uint64_t subset, const Mask &fired, uint64_t key, double cutoff, int &bestCell);
+
+        const ShipShape<BoardType> *m_shapes[MAX_SHIP_NUM + 1][ShipShape<BoardType>::MAX_VARIANTS];  // by length
+        int m_numShapes[MAX_SHIP_NUM + 1];
+
+        Layout m_layouts[MAX_LAYOUTS];
+        int m_numLayouts;
+        const int *m_lengths;
+        int m_numFloating;
+        Mask m_hits;
+        int m_listed;
+
+        std::unordered_map<uint64_t, Solved> m_memo;
+        long m_nodes;
+        bool m_aborted;
+        double m_lastExpected;
+};
+
+extern template class Endgame<NormalBoard>;
+extern template class Endgame<XLBoard>;
+
+#endif
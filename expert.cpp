@@ -0,0 +1,303 @@
+//EXPERT CPP
+
+#include "expert.h"
+#include "stats.h"
+#include "transposition.h"
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * @brief One move's worth of sampling, shared by the threads working on it
+ *
+ */
+template <class BoardType>
+struct Expert<BoardType>::Job
+{
+    const Observation *seen;
+    int numChunks;
+    bool timed;
+    double scale;   // turns a fleet's weight into tally units
+    std::chrono::steady_clock::time_point deadline;
+
+    std::atomic<int> nextChunk;
+    std::atomic<int> chunksDone;
+    std::atomic<int> samples;
+
+    std::mutex lock;
+    std::condition_variable finished;
+    int helpersRunning;
+};
+
+template <class BoardType>
+Expert<BoardType>::Expert() {
+    for (int length = 0; length <= MAX_SHIP_NUM; length++) {
+        m_numShapes[length] = ShipShape<BoardType>::variants(length, m_shapes[length]);
+    }
+    for (int cell = 0; cell < BoardType::CELLS; cell++) {
+        m_tally[cell] = 0;
+    }
+    m_samples = 20000;
+    m_milliseconds = 100;
+    m_lastSamples = 0;
+    m_seed = 0;
+    m_stream = 0;
+    m_moves = 0;
+}
+
+template <class BoardType>
+void Expert<BoardType>::seed(uint64_t seedValue, uint64_t stream) {
+    machine.seed(seedValue, stream);
+    m_seed = seedValue;
+    m_stream = stream;
+    m_moves = 0;
+    m_endgame.clear();
+}
+
+template <class BoardType>
+void Expert<BoardType>::setBudget(int samples, int milliseconds) {
+    m_samples = samples > 0 ? samples : 1;
+    m_milliseconds = milliseconds > 0 ? milliseconds : 0;
+}
+
+template <class BoardType>
+int Expert<BoardType>::getLastSamples() const { return m_lastSamples; }
+
+template <class BoardType>
+uint64_t Expert<BoardType>::chunkStream(int chunk) const {
+    return (m_stream << 48) ^ (m_moves << 24) ^ static_cast<uint64_t>(chunk);
+}
+
+template <class BoardType>
+ThreadPool &Expert<BoardType>::pool() {
+    static ThreadPool shared;
+    return shared;
+}
+
+template <class BoardType>
+double Expert<BoardType>::sampleFleet(const Observation &seen, Machine &rng, Mask &occupied) const {
+    struct Placement {
+        short ship;
+        short corner;
+        const ShipShape<BoardType> *shape;
+    };
+    Placement options[MAX_SHIP_NUM * ShipShape<BoardType>::MAX_VARIANTS * MAX_SHIP_NUM];
+    bool placed[MAX_SHIP_NUM] = {false};
+
+    Mask free = seen.free;
+    Mask uncovered = seen.hits;
+    occupied.clear();
+    double weight = 1;
+
+    // Cover the open hits first, lowest cell first, with any unplaced ship through it
+    while (uncovered.any()) {
+        int hit = uncovered.first();
+        int numOptions = 0;
+
+        for (int ship = 0; ship < seen.numFloating; ship++) {
+            if (placed[ship]) {
+                continue;
+            }
+            int length = seen.lengths[ship];
+            for (int v = 0; v < m_numShapes[length]; v++) {
+                const ShipShape<BoardType> *shape = m_shapes[length][v];
+                for (int k = 0; k < shape->getNumCells(); k++) {
+                    int corner;
+                    if (!shape->cornerFor(hit, k, corner)) {
+                        continue;
+                    }
+                    Mask cells = shape->cellsAt(corner);
+                    // A floating ship cannot be hit on every cell
+                    if (!cells.andNot(free).any() && cells.andNot(seen.hits).any()) {
+                        Placement option = {static_cast<short>(ship), static_cast<short>(corner), shape};
+                        options[numOptions++] = option;
+                    }
+                }
+            }
+        }
+        if (numOptions == 0) {
+            return 0;
+        }
+        weight *= numOptions;
+
+        const Placement &chosen = options[rng.randomBelow(numOptions)];
+        placed[chosen.ship] = true;
+        Mask cells = chosen.shape->cellsAt(chosen.corner);
+        free = free.andNot(cells);
+        uncovered = uncovered.andNot(cells);
+        occupied |= cells;
+    }
+
+    // Every hit is covered and off the free mask, so the other ships go on untried cells
+    for (int ship = 0; ship < seen.numFloating; ship++) {
+        if (placed[ship]) {
+            continue;
+        }
+        int length = seen.lengths[ship];
+        Mask corners[ShipShape<BoardType>::MAX_VARIANTS];
+        int counts[ShipShape<BoardType>::MAX_VARIANTS];
+        int total = 0;
+        for (int v = 0; v < m_numShapes[length]; v++) {
+            corners[v] = m_shapes[length][v]->legalCorners(free);
+            counts[v] = corners[v].count();
+            total += counts[v];
+        }
+        if (total == 0) {
+            return 0;
+        }
+        weight *= total;
+        int choice = rng.randomBelow(total);
+        int v = 0;
+        while (choice >= counts[v]) {
+            choice -= counts[v++];
+        }
+        Mask cells = m_shapes[length][v]->cellsAt(corners[v].nth(choice));
+        free = free.andNot(cells);
+        occupied |= cells;
+    }
+    return weight;
+}
+
+template <class BoardType>
+void Expert<BoardType>::runChunks(Job &job) {
+    uint64_t units[BoardType::CELLS];
+
+    while (true) {
+        // Past the deadline, stop once something has been counted
+        if (job.timed && job.chunksDone > 0 && std::chrono::steady_clock::now() >= job.deadline) {
+            return;
+        }
+        int chunk = job.nextChunk++;
+        if (chunk >= job.numChunks) {
+            return;
+        }
+
+        Machine rng(m_seed, chunkStream(chunk));
+        for (int cell = 0; cell < BoardType::CELLS; cell++) {
+            units[cell] = 0;
+        }
+        int drawn = 0;
+        Mask occupied;
+        for (int i = 0; i < CHUNK; i++) {
+            double weight = sampleFleet(*job.seen, rng, occupied);
+            if (weight == 0) {
+                continue;
+            }
+            drawn++;
+            double scaled = weight * job.scale;
+            uint64_t fleetUnits = scaled < MAX_UNITS ? static_cast<uint64_t>(scaled) : static_cast<uint64_t>(MAX_UNITS);
+            Mask cells = occupied & job.seen->untried;
+            for (int cell = cells.first(); cell >= 0; cell = cells.first()) {
+                cells.reset(cell);
+                units[cell] += fleetUnits;
+            }
+        }
+
+        for (int cell = 0; cell < BoardType::CELLS; cell++) {
+            if (units[cell]) {
+                m_tally[cell].fetch_add(units[cell], std::memory_order_relaxed);
+            }
+        }
+        job.samples.fetch_add(drawn, std::memory_order_relaxed);
+        STATS_ADD(EXPERT_FLEETS_SAMPLED, drawn);
+        job.chunksDone++;
+    }
+}
+
+template <class BoardType>
+int Expert<BoardType>::chooseShot(Player<BoardType> &attacker, Player<BoardType> &defender) {
+    const int numShips = defender.my_ships.getNumShips();
+    Observation seen;
+    Mask sunkCells;
+    bool floating[MAX_SHIP_NUM + 1] = {false};
+    seen.numFloating = 0;
+    for (int ship = numShips; ship >= 1; ship--) {
+        if (defender.my_ships.shipNumIsSunk(ship)) {
+            sunkCells |= defender.my_ships.getShipMask(ship);
+        } else {
+            seen.lengths[seen.numFloating++] = ship;
+            floating[ship] = true;
+        }
+    }
+
+    const Mask &hits = attacker.enemy_ships.getHitMask();
+    const Mask &misses = attacker.enemy_ships.getMissMask();
+    seen.free = Mask::full().andNot(misses | sunkCells);
+    seen.hits = hits.andNot(sunkCells);
+    seen.untried = Mask::full().andNot(hits | misses);
+
+    if (EXACT_ENDGAME) {
+        int cell;
+        uint64_t key = positionKey(attacker.enemy_ships, sunkCells, floating, numShips);
+        if (m_endgame.solve(seen.free, seen.hits, seen.untried, seen.lengths, seen.numFloating, key, cell)) {
+            m_lastSamples = 0;
+            return cell;
+        }
+    }
+
+    for (int cell = 0; cell < BoardType::CELLS; cell++) {
+        m_tally[cell].store(0, std::memory_order_relaxed);
+    }
+
+    // Integer units keep the sums the same whichever thread adds first. A
+    // pilot fleet sets the scale; much lighter fleets round down to nothing.
+    double pilot = 0;
+    Machine pilotRng(m_seed, chunkStream(PILOT_CHUNK));
+    for (int i = 0; i < CHUNK && pilot == 0; i++) {
+        Mask occupied;
+        pilot = sampleFleet(seen, pilotRng, occupied);
+    }
+
+    Job job;
+    job.seen = &seen;
+    job.scale = pilot > 0 ? std::ldexp(1.0, PILOT_BITS - std::ilogb(pilot)) : 0;
+    job.numChunks = (m_samples + CHUNK - 1) / CHUNK;
+    job.timed = m_milliseconds > 0;
+    job.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_milliseconds);
+    job.nextChunk = 0;
+    job.chunksDone = 0;
+    job.samples = 0;
+
+    // The calling thread works too, so one chunk needs no helpers at all
+    ThreadPool &helpers = pool();
+    int numHelpers = job.numChunks - 1 < helpers.getNumThreads() ? job.numChunks - 1 : helpers.getNumThreads();
+    job.helpersRunning = numHelpers;
+    for (int i = 0; i < numHelpers; i++) {
+        helpers.submit([this, &job]() {
+            runChunks(job);
+            std::lock_guard<std::mutex> guard(job.lock);
+            if (--job.helpersRunning == 0) {
+                job.finished.notify_one();
+            }
+        });
+    }
+    runChunks(job);
+    {
+        std::unique_lock<std::mutex> lock(job.lock);
+        job.finished.wait(lock, [&job] { return job.helpersRunning == 0; });
+    }
+    m_lastSamples = job.samples;
+    m_moves++;
+
+    // Fire at the untried cell in the most fleets; ties (or no fleets at all) are broken at random
+    Mask best;
+    uint64_t bestCount = 0;
+    Mask untried = seen.untried;
+    for (int cell = untried.first(); cell >= 0; cell = untried.first()) {
+        untried.reset(cell);
+        uint64_t count = m_tally[cell].load(std::memory_order_relaxed);
+        if (count > bestCount || !best.any()) {
+            bestCount = count;
+            best.clear();
+        }
+        if (count == bestCount) {
+            best.set(cell);
+        }
+    }
+
+    return best.nth(machine.randomBelow(best.count()));
+}
+
+template class Expert<NormalBoard>;
+template class Expert<XLBoard>;
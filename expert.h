@@ -0,0 +1,149 @@
+//EXPERT H
+
+#ifndef EXPERT_H
+#define EXPERT_H
+
+#include "player.h"
+#include "machine.h"
+#include "endgame.h"
+#include "placement.h"
+#include "thread_pool.h"
+#include <atomic>
+
+/**
+ * @brief The expert difficulty AI: fires at the cell occupied in the most sampled enemy fleets
+ *
+ * Each turn the AI draws many complete fleets which agree with everything it
+ * has seen: no ship on a miss, the sunk ships where they sank, every open hit
+ * covered, and no floating ship made up of hits only. A fleet is built one ship
+ * at a time without retries in the common case: while some hit is uncovered the
+ * next ship is a random placement of any of its shapes (ShipShape::variants) through
+ * the lowest such hit, and the rest go on random free cells, longest first.
+ * Only when a ship has nowhere left to go is the fleet dropped.
+ *
+ * Building a fleet this way makes some fleets likelier than others, but each
+ * fleet has only one way to be built, so weighting it by the product of the
+ * number of choices at every step counts every consistent fleet equally.
+ *
+ * The samples are split into chunks of CHUNK, each drawn from its own random
+ * stream, so the tally does not depend on which thread ran which chunk. Chunks
+ * are handed out to a process-wide ThreadPool and to the calling thread, every
+ * chunk is counted locally and then added to the shared per-cell tally with
+ * relaxed atomic adds. The AI stops at its sample budget or its time budget,
+ * whichever comes first.
+ *
+ * On the normal board, once few enough fleets remain that Endgame can list
+ * them all, the AI stops sampling and fires where that exact search says the
+ * game ends soonest on average.
+ */
+template <class BoardType>
+class Expert{
+
+    public:
+        /**
+         * @brief Construct a new Expert AI with the default budget
+         *
+         */
+        Expert();
+
+        /**
+         * @brief Restart the AI's random streams
+         *
+         * @param seedValue The seed
+         * @param stream The stream id; the sampling chunks use streams derived from it
+         */
+        void seed(uint64_t seedValue, uint64_t stream);
+
+        /**
+         * @brief Set how much work the AI may do per move
+         *
+         * @param samples The most fleets to draw per move
+         * @param milliseconds The most time to spend per move, or 0 for no limit (the moves are then reproducible from the seed)
+         */
+        void setBudget(int samples, int milliseconds);
+
+        /**
+         * @brief Choose where to fire next. Does not fire.
+         *
+         * @param attacker The AI's player
+         * @param defender The player being fired at; only its sunk ships are looked at
+         * @return int The cell to fire at (row * numCols + col)
+         */
+        int chooseShot(Player<BoardType> &attacker, Player<BoardType> &defender);
+
+        /**
+         * @brief Get the number of consistent fleets drawn for the last move
+         *
+         * @return int The number of fleets
+         */
+        int getLastSamples() const;
+
+    private:
+        typedef typename BoardType::Mask Mask;
+
+        static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+        static const int CHUNK = 64;
+        static const int PILOT_CHUNK = 0xFFFFFF;   // stream of the pilot fleet, past any real chunk
+        static const int PILOT_BITS = 24;          // a fleet as heavy as the pilot is worth 2^24 units
+        static constexpr double MAX_UNITS = 281474976710656.0;   // 2^48, so 2^16 heavy fleets still fit in 64 bits
+        static const bool EXACT_ENDGAME = Mask::WORDS <= 2;      // the XL board's endgames are too wide to search
+
+        /**
+         * @brief Everything the AI knows about the enemy fleet this turn
+         *
+         */
+        struct Observation
+        {
+            Mask free;       // cells a floating ship may occupy: not a miss, not a sunk ship
+            Mask hits;       // hits not on a sunk ship; each must be covered
+            Mask untried;    // cells not fired at yet
+            int lengths[MAX_SHIP_NUM];   // the floating ships, longest first
+            int numFloating;
+        };
+
+        struct Job;
+
+        /**
+         * @brief Draw one fleet consistent with seen
+         *
+         * @param seen The observation
+         * @param rng The random stream to draw from
+         * @param occupied Set to the cells of the fleet's floating ships
+         * @return double The fleet's weight, or 0 if some ship had no legal placement left (occupied is then meaningless)
+         */
+        double sampleFleet(const Observation &seen, Machine &rng, Mask &occupied) const;
+
+        /**
+         * @brief Get the random stream of one chunk of this move's samples
+         *
+         */
+        uint64_t chunkStream(int chunk) const;
+
+        /**
+         * @brief Take chunks off a job until it runs out of chunks or time
+         *
+         */
+        void runChunks(Job &job);
+
+        /**
+         * @brief Get the pool shared by every Expert in the process, started on first use
+         *
+         */
+        static ThreadPool &pool();
+
+        const ShipShape<BoardType> *m_shapes[MAX_SHIP_NUM + 1][ShipShape<BoardType>::MAX_VARIANTS];  // by length
+        int m_numShapes[MAX_SHIP_NUM + 1];
+        Endgame<BoardType> m_endgame;
+        std::atomic<uint64_t> m_tally[BoardType::CELLS];  // weight of the sampled fleets occupying each cell
+        int m_samples;
+        int m_milliseconds;
+        int m_lastSamples;
+        uint64_t m_seed;
+        uint64_t m_stream;
+        uint64_t m_moves;
+        Machine machine;
+};
+
+extern template class Expert<NormalBoard>;
+extern template class Expert<XLBoard>;
+#endif
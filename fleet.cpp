@@ -0,0 +1,154 @@
+#include "fleet.h"
+#include "stats.h"
+
+template <class BoardType>
+FleetGenerator<BoardType>::FleetGenerator(int numShips)
+{
+    m_numShips = numShips;
+
+    // Rule out fleets which could never fit before searching for one
+    int cells = 0;
+    m_possible = numShips >= 0 && numShips <= Fleet<BoardType>::MAX_SHIP_NUM;
+    for (int size = 1; size <= numShips && m_possible; size++)
+    {
+        m_possible = ShipShape<BoardType>::find(size, 'R') != NULL;
+        cells += size;
+    }
+    m_possible = m_possible && cells <= BoardType::CELLS;
+
+    // Every placement of each ship on the empty board, which draw() picks from
+    for (int size = 1; size <= numShips && m_possible; size++)
+    {
+        int numShapes = ShipShape<BoardType>::variants(size, m_shapes[size]);
+        m_placements[size] = 0;
+        for (int v = 0; v < numShapes; v++)
+        {
+            m_pivots[size][v] = m_shapes[size][v]->legalPivots(Mask::full());
+            m_counts[size][v] = m_pivots[size][v].count();
+            m_placements[size] += m_counts[size][v];
+        }
+    }
+}
+
+template <class BoardType>
+bool FleetGenerator<BoardType>::generate(Machine &rng, Fleet<BoardType> &fleet) const
+{
+    fleet.numShips = m_numShips;
+    if (!m_possible) return false;
+    for (int attempt = 0; attempt < MAX_DRAWS; attempt++)
+    {
+        if (draw(rng, fleet)) return true;
+        STATS_COUNT(FLEET_REJECTIONS);
+    }
+    return search(rng, fleet);
+}
+
+template <class BoardType>
+bool FleetGenerator<BoardType>::draw(Machine &rng, Fleet<BoardType> &fleet) const
+{
+    Mask occupied;
+    for (int size = m_numShips; size >= 1; size--)
+    {
+        int choice = rng.randomBelow(m_placements[size]);
+        int v = 0;
+        while (choice >= m_counts[size][v]) choice -= m_counts[size][v++];
+        int pivot = m_pivots[size][v].nth(choice);
+
+        // Any overlap throws the whole fleet away, so every legal fleet stays equally likely
+        Mask cells;
+        m_shapes[size][v]->at(pivot / BoardType::COLS, pivot % BoardType::COLS, cells);
+        if ((cells & occupied).any()) return false;
+        occupied |= cells;
+        fleet.pivot[size] = static_cast<short>(pivot);
+        fleet.direction[size] = m_shapes[size][v]->getDirection();
+        fleet.orientation[size] = static_cast<char>(m_shapes[size][v]->getOrientation());
+    }
+    return true;
+}
+
+template <class BoardType>
+bool FleetGenerator<BoardType>::search(Machine &rng, Fleet<BoardType> &fleet) const
+{
+    // One level per ship, longest first: the placements not tried yet and the cells taken
+    Mask candidates[MAX_SHIP_NUM][MAX_VARIANTS];
+    Mask taken[MAX_SHIP_NUM];
+    Mask occupied;
+    bool descending = true;
+
+    int depth = 0;
+    while (depth < m_numShips)
+    {
+        int size = m_numShips - depth;
+        const ShipShape<BoardType> *shapes[MAX_VARIANTS];
+        int numShapes = ShipShape<BoardType>::variants(size, shapes);
+
+        if (descending)
+        {
+            Mask free = Mask::full().andNot(occupied);
+            for (int v = 0; v < numShapes; v++)
+            {
+                candidates[depth][v] = shapes[v]->legalPivots(free);
+            }
+        }
+
+        int counts[MAX_VARIANTS];
+        int total = 0;
+        for (int v = 0; v < numShapes; v++)
+        {
+            counts[v] = candidates[depth][v].count();
+            total += counts[v];
+        }
+        if (total == 0)
+        {
+            // Nowhere left for this ship: the one before it tries somewhere else
+            if (depth == 0) return false;
+            STATS_COUNT(FLEET_BACKTRACKS);
+            depth--;
+            occupied = occupied.andNot(taken[depth]);
+            descending = false;
+            continue;
+        }
+
+        int choice = rng.randomBelow(total);
+        int v = 0;
+        while (choice >= counts[v]) choice -= counts[v++];
+        int pivot = candidates[depth][v].nth(choice);
+        candidates[depth][v].reset(pivot);
+
+        shapes[v]->at(pivot / BoardType::COLS, pivot % BoardType::COLS, taken[depth]);
+        occupied |= taken[depth];
+        fleet.pivot[size] = static_cast<short>(pivot);
+        fleet.direction[size] = shapes[v]->getDirection();
+        fleet.orientation[size] = static_cast<char>(shapes[v]->getOrientation());
+        depth++;
+        descending = true;
+    }
+    return true;
+}
+
+template <class BoardType>
+int FleetGenerator<BoardType>::generateBatch(Machine &rng, Fleet<BoardType> *fleets, int count) const
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (!generate(rng, fleets[i])) return 0;
+    }
+    return count;
+}
+
+template <class BoardType>
+bool FleetGenerator<BoardType>::apply(const Fleet<BoardType> &fleet, Player<BoardType> &player)
+{
+    for (int ship = 1; ship <= fleet.numShips; ship++)
+    {
+        int row = fleet.pivot[ship] / BoardType::COLS;
+        int col = fleet.pivot[ship] % BoardType::COLS;
+        if (!player.PlaceShipAI(ship, row, col, fleet.direction[ship], fleet.orientation[ship])) return false;
+    }
+    return true;
+}
+
+template struct Fleet<NormalBoard>;
+template struct Fleet<XLBoard>;
+template class FleetGenerator<NormalBoard>;
+template class FleetGenerator<XLBoard>;
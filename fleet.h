@@ -0,0 +1,129 @@
+/*------------------------------------------------------------
+ * @Filename: fleet.h
+ * @Description: random fleet layouts, every legal one equally likely
+ ------------------------------------------------------------*/
+
+#ifndef FLEET_H
+#define FLEET_H
+
+#include "player.h"
+#include "machine.h"
+
+/**
+ * @brief Where each ship of one fleet goes, in the form PlaceShipAI takes
+ *
+ */
+template <class BoardType>
+struct Fleet
+{
+    static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+
+    int numShips;
+    short pivot[MAX_SHIP_NUM + 1];       // indexed by ship number: row * numCols + col
+    char direction[MAX_SHIP_NUM + 1];
+    char orientation[MAX_SHIP_NUM + 1];  // of a bent ship, else 0
+};
+
+/**
+ * @brief Draws random fleet layouts
+ *
+ * Every legal fleet is equally likely. Each ship is drawn uniformly and
+ * independently from its placements on the empty board (found once, in the
+ * constructor, with ShipShape::legalPivots), and the whole fleet is thrown
+ * away and drawn again if any two ships overlap. Each legal fleet is one
+ * combination of those draws, so every legal fleet has the same chance.
+ *
+ * A crowded fleet can be rejected nearly every time. After MAX_DRAWS tries
+ * the generator searches instead: ships are placed longest first, each drawn
+ * from the placements still legal given the ships already down, backtracking
+ * to the ship before when one has nowhere to go. That search always finds a
+ * fleet if one exists, but its fleets are not equally likely, since it does
+ * not weight a placement by how many ways the rest of the fleet can still be
+ * completed.
+ *
+ * The shapes are those of ShipShape::variants: a straight ship is only drawn
+ * facing 'D' or 'R' (size 1 always faces 'U') and a bent ship in each of its
+ * distinct orientations, so each set of cells is one placement rather than
+ * several.
+ */
+template <class BoardType>
+class FleetGenerator
+{
+    public:
+        typedef typename BoardType::Mask Mask;
+
+        static const int MAX_DRAWS = 1 << 16;   // whole-fleet draws before generate() falls back to searching
+
+        /**
+         * @brief Construct a generator for fleets of ships 1 to numShips
+         *
+         * @param numShips The number of ships per fleet
+         */
+        explicit FleetGenerator(int numShips);
+
+        /**
+         * @brief Draw one fleet
+         *
+         * @param rng The random numbers to draw with
+         * @param fleet Set to the fleet
+         * @return true A fleet was drawn
+         * @return false The ships cannot all fit on the board
+         */
+        bool generate(Machine &rng, Fleet<BoardType> &fleet) const;
+
+        /**
+         * @brief Draw count independent fleets into a buffer the caller owns
+         *
+         * @param rng The random numbers to draw with
+         * @param fleets The buffer, at least count long
+         * @param count The number of fleets to draw
+         * @return int The number of fleets drawn: count, or 0 if the ships cannot all fit
+         */
+        int generateBatch(Machine &rng, Fleet<BoardType> *fleets, int count) const;
+
+        /**
+         * @brief Place a fleet on a player's empty board
+         *
+         * @param fleet The fleet
+         * @param player The player whose my_ships to place on
+         * @return true Every ship was placed
+         * @return false Some ship did not fit (the board was not empty)
+         */
+        static bool apply(const Fleet<BoardType> &fleet, Player<BoardType> &player);
+
+    private:
+        static const int MAX_SHIP_NUM = Fleet<BoardType>::MAX_SHIP_NUM;
+        static const int MAX_VARIANTS = ShipShape<BoardType>::MAX_VARIANTS;
+
+        /**
+         * @brief Draw every ship from its empty-board placements, once
+         *
+         * @return true The ships do not overlap, and fleet holds them
+         * @return false Two ships overlap; fleet is partly written
+         */
+        bool draw(Machine &rng, Fleet<BoardType> &fleet) const;
+
+        /**
+         * @brief Place the ships one at a time, backtracking when one has nowhere to go
+         *
+         * @return true A fleet was found
+         * @return false No fleet fits
+         */
+        bool search(Machine &rng, Fleet<BoardType> &fleet) const;
+
+        int m_numShips;
+        bool m_possible;   // false if some ship is longer than the board or the ships outnumber the cells
+
+        // Indexed by ship size: each shape, its pivots on the empty board and how many there are
+        const ShipShape<BoardType> *m_shapes[MAX_SHIP_NUM + 1][MAX_VARIANTS];
+        Mask m_pivots[MAX_SHIP_NUM + 1][MAX_VARIANTS];
+        int m_counts[MAX_SHIP_NUM + 1][MAX_VARIANTS];
+        int m_placements[MAX_SHIP_NUM + 1];
+};
+
+extern template struct Fleet<NormalBoard>;
+extern template struct Fleet<XLBoard>;
+extern template class FleetGenerator<NormalBoard>;
+extern template class FleetGenerator<XLBoard>;
+
+#endif
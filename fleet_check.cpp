@@ -0,0 +1,155 @@
+/*------------------------------------------------------------
+ * @Filename: fleet_check.cpp
+ * @Description: fleet-check, tests that FleetGenerator draws every legal fleet equally often
+ ------------------------------------------------------------*/
+
+#include "fleet.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    typedef NormalBoard BoardType;
+    typedef BoardType::Mask Mask;
+
+    const int NUM_SHIPS = 4;
+    const int FLEETS = 1000000;
+    const int MAX_VARIANTS = ShipShape<BoardType>::MAX_VARIANTS;
+
+    /**
+     * @brief Every placement of one ship on the empty board, and how many legal fleets use each
+     *
+     */
+    struct ShipPlacements
+    {
+        vector<Mask> cells;
+        vector<int> index;         // [variant * CELLS + pivot], -1 where the ship does not fit
+        vector<double> fleets;     // exact count of legal fleets using each placement
+        vector<long> drawn;
+    };
+
+    /**
+     * @brief Count, for every placement of every ship, the legal fleets which use it
+     *
+     * Ships NUM_SHIPS down to 2 are enumerated; ship 1 is a single cell, so it
+     * fits in each free cell of the others.
+     */
+    void countFleets(ShipPlacements ships[])
+    {
+        for (int size = 2; size <= NUM_SHIPS; size++) ships[size].fleets.assign(ships[size].cells.size(), 0);
+        ships[1].fleets.assign(ships[1].cells.size(), 0);
+
+        vector<int> chosen(NUM_SHIPS + 1);
+        vector<Mask> taken(NUM_SHIPS + 2);
+        int size = NUM_SHIPS;
+        chosen[size] = -1;
+        while (size <= NUM_SHIPS)
+        {
+            if (++chosen[size] == static_cast<int>(ships[size].cells.size()))
+            {
+                size++;
+                continue;
+            }
+            const Mask &cells = ships[size].cells[chosen[size]];
+            if ((cells & taken[size + 1]).any()) continue;
+            taken[size] = taken[size + 1] | cells;
+            if (size > 2)
+            {
+                chosen[--size] = -1;
+                continue;
+            }
+
+            int free = BoardType::CELLS - taken[2].count();
+            for (int s = 2; s <= NUM_SHIPS; s++) ships[s].fleets[chosen[s]] += free;
+            for (int cell = 0; cell < BoardType::CELLS; cell++)
+            {
+                if (!taken[2].test(cell)) ships[1].fleets[ships[1].index[cell]]++;
+            }
+        }
+    }
+
+    /**
+     * @brief Pearson's chi-squared statistic of one ship's draws against its exact fleet counts
+     *
+     */
+    double chiSquared(const ShipPlacements &ship)
+    {
+        double total = 0;
+        for (size_t p = 0; p < ship.fleets.size(); p++) total += ship.fleets[p];
+        double statistic = 0;
+        for (size_t p = 0; p < ship.fleets.size(); p++)
+        {
+            double expected = FLEETS * ship.fleets[p] / total;
+            statistic += (ship.drawn[p] - expected) * (ship.drawn[p] - expected) / expected;
+        }
+        return statistic;
+    }
+}
+
+int main()
+{
+    ShipPlacements ships[NUM_SHIPS + 1];
+    for (int size = 1; size <= NUM_SHIPS; size++)
+    {
+        const ShipShape<BoardType> *shapes[MAX_VARIANTS];
+        int numShapes = ShipShape<BoardType>::variants(size, shapes);
+        ships[size].index.assign(MAX_VARIANTS * BoardType::CELLS, -1);
+        for (int v = 0; v < numShapes; v++)
+        {
+            for (int pivot = 0; pivot < BoardType::CELLS; pivot++)
+            {
+                Mask cells;
+                if (!shapes[v]->at(pivot / BoardType::COLS, pivot % BoardType::COLS, cells)) continue;
+                ships[size].index[v * BoardType::CELLS + pivot] = ships[size].cells.size();
+                ships[size].cells.push_back(cells);
+            }
+        }
+        ships[size].drawn.assign(ships[size].cells.size(), 0);
+    }
+    countFleets(ships);
+
+    Machine rng;
+    rng.seed(1, 0);
+    FleetGenerator<BoardType> generator(NUM_SHIPS);
+    Fleet<BoardType> fleet;
+    for (int i = 0; i < FLEETS; i++)
+    {
+        if (!generator.generate(rng, fleet))
+        {
+            printf("fleet-check: no fleet of %d ships was drawn\n", NUM_SHIPS);
+            return 1;
+        }
+        for (int size = 1; size <= NUM_SHIPS; size++)
+        {
+            const ShipShape<BoardType> *shape = ShipShape<BoardType>::find(size, fleet.direction[size], fleet.orientation[size]);
+            const ShipShape<BoardType> *shapes[MAX_VARIANTS];
+            int numShapes = ShipShape<BoardType>::variants(size, shapes);
+            int v = 0;
+            while (v < numShapes && shapes[v] != shape) v++;
+            int p = v < numShapes ? ships[size].index[v * BoardType::CELLS + fleet.pivot[size]] : -1;
+            if (p < 0)
+            {
+                printf("fleet-check: ship %d was drawn off the board\n", size);
+                return 1;
+            }
+            ships[size].drawn[p]++;
+        }
+    }
+
+    // A fixed seed makes the run repeatable; the bound is 6 standard deviations above the mean
+    bool uniform = true;
+    for (int size = 1; size <= NUM_SHIPS; size++)
+    {
+        int freedom = static_cast<int>(ships[size].cells.size()) - 1;
+        double bound = freedom + 6 * sqrt(2.0 * freedom);
+        double statistic = chiSquared(ships[size]);
+        printf("ship %d: chi-squared %.1f over %d placements (at most %.1f)\n", size, statistic, freedom + 1, bound);
+        uniform = uniform && statistic <= bound;
+    }
+    printf("fleet-check: %s\n", uniform ? "every legal fleet is drawn equally often"
+                                        : "some fleets are drawn more often than others");
+    return uniform ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include "game_engine.h"
+
+template <class BoardType>
+GameEngine<BoardType>::GameEngine(int numShips, Controller player1, Controller player2)
+{
+    Machine clock;   // seeded from the clock on its own stream
+    uint64_t seed = clock.next();
+    init(numShips, player1, player2, (seed << 32) | clock.next());
+}
+
+template <class BoardType>
+GameEngine<BoardType>::GameEngine(int numShips, Controller player1, Controller player2, uint64_t seed)
+{
+    init(numShips, player1, player2, seed);
+}
+
+template <class BoardType>
+void GameEngine<BoardType>::init(int numShips, Controller player1, Controller player2, uint64_t seed)
+{
+    m_seed = seed;
+    m_numShips = numShips;
+    m_round = 0;
+    m_controllers[0] = player1;
+    m_controllers[1] = player2;
+
+    // Separate streams keep fleet placement and each side's AI independent
+    m_machine.seed(seed, 0);
+    m_machine.setGameMode(getGameMode());
+
+    for (int i = 0; i < 2; i++)
+    {
+        m_players[i].my_ships.updateNumShips(numShips);
+        m_players[i].enemy_ships.updateNumShips(numShips);
+        m_fleets[i] = Fleet<BoardType>();
+        m_fleets[i].numShips = numShips;
+    }
+}
+
+template <class BoardType>
+bool GameEngine<BoardType>::placeShip(int side, int size, int row, int col, char direction, int orientation)
+{
+    if (!getPlayer(side).PlaceShip(size, row, col, direction, orientation)) return false;
+
+    Fleet<BoardType> &fleet = m_fleets[side - 1];
+    fleet.pivot[size] = static_cast<short>(row * BoardType::COLS + col);
+    fleet.direction[size] = direction;
+    fleet.orientation[size] = static_cast<char>(orientation);
+    return true;
+}
+
+template <class BoardType>
+void GameEngine<BoardType>::placeFleet(int side)
+{
+    FleetGenerator<BoardType> generator(m_numShips);
+    Fleet<BoardType> &fleet = m_fleets[side - 1];
+    if (generator.generate(m_machine, fleet))
+    {
+        FleetGenerator<BoardType>::apply(fleet, getPlayer(side));
+    }
+}
+
+template <class BoardType>
+Shot GameEngine<BoardType>::fire(int row, int col)
+{
+    Shot shot = m_players[m_round % 2].Fire(m_players[(m_round + 1) % 2], row, col);
+    if (shot.result != SHOT_INVALID) m_round++;
+    return shot;
+}
+
+template <class BoardType>
+bool GameEngine<BoardType>::isOver()
+{
+    return m_players[0].my_ships.allShipsSunk() || m_players[1].my_ships.allShipsSunk();
+}
+
+template <class BoardType>
+int GameEngine<BoardType>::getWinner()
+{
+    if (m_players[1].my_ships.allShipsSunk()) return 1;
+    if (m_players[0].my_ships.allShipsSunk()) return 2;
+    return 0;
+}
+
+template <class BoardType>
+int GameEngine<BoardType>::getCurrentSide() { return (m_round % 2) + 1; }
+
+template <class BoardType>
+int GameEngine<BoardType>::getRound() { return m_round; }
+
+template <class BoardType>
+int GameEngine<BoardType>::getNumShips() { return m_numShips; }
+
+template <class BoardType>
+Controller GameEngine<BoardType>::getController(int side) { return m_controllers[side - 1]; }
+
+template <class BoardType>
+Player<BoardType> &GameEngine<BoardType>::getPlayer(int side) { return m_players[side - 1]; }
+
+template class GameEngine<NormalBoard>;
+template class GameEngine<XLBoard>;
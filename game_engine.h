@@ -0,0 +1,224 @@
+/*------------------------------------------------------------
+ * @Filename: game_engine.h
+ * @Description: the rules of a game of battleship, without any terminal I/O
+ ------------------------------------------------------------*/
+
+#ifndef GAME_ENGINE_H
+#define GAME_ENGINE_H
+
+#include "board.h"
+#include "player.h"
+#include "machine.h"
+#include "strategy.h"
+#include "fleet.h"
+#include <cassert>
+
+/**
+ * @brief Runs one game between two sides on a BoardType board
+ *
+ * The engine owns both players; the AI strategies belong to whoever drives
+ * the game. Sides are numbered 1 and 2 and side 1 fires first. A front end
+ * places the fleets (placeShip for human sides, placeFleet for AI sides),
+ * then fires for human sides and calls playTurn for AI sides until isOver().
+ * playGame plays two strategies fixed at compile time to the end; Executive
+ * plays the AnyStrategy each side's Controller names.
+ */
+template <class BoardType>
+class GameEngine
+{
+    public:
+        /**
+         * @brief Construct a new game
+         *
+         * @param numShips The number of ships per player
+         * @param player1 The controller of side 1
+         * @param player2 The controller of side 2
+         */
+        GameEngine(int numShips, Controller player1, Controller player2);
+
+        /**
+         * @brief Construct a new game whose AI moves and fleets are fixed by a seed
+         *
+         * @param numShips The number of ships per player
+         * @param player1 The controller of side 1
+         * @param player2 The controller of side 2
+         * @param seed Every random choice in the game is derived from this
+         */
+        GameEngine(int numShips, Controller player1, Controller player2, uint64_t seed);
+
+        /**
+         * @brief Return the game mode this engine plays
+         *
+         * @return char 'X' for an XL board, 'N' otherwise
+         */
+        static char getGameMode() { return BoardType::checkBig() ? 'X' : 'N'; }
+
+        /**
+         * @brief Attempt to place one ship for a side
+         *
+         * @param side The side placing the ship (1 or 2)
+         * @param size The size of the ship
+         * @param row The row of the pivot
+         * @param col The column of the pivot
+         * @param direction The direction to face the ship, or 'V' / 'N' for a bent ship
+         * @param orientation Which way to turn a bent ship, 0 to 7 (see Orientations)
+         * @return true Placement succeded
+         * @return false Placement failed
+         */
+        bool placeShip(int side, int size, int row, int col, char direction, int orientation = 0);
+
+        /**
+         * @brief Randomly place every ship for a side, on an empty board
+         *
+         * @param side The side to place (1 or 2)
+         */
+        void placeFleet(int side);
+
+        /**
+         * @brief The current side fires at the other side
+         *
+         * @param row The row to fire at
+         * @param col The column to fire at
+         * @return Shot The outcome and the ship struck. The turn passes unless it is SHOT_INVALID.
+         */
+        Shot fire(int row, int col);
+
+        /**
+         * @brief Draw an untried cell for a side, from the engine's own random stream
+         *
+         * playTurn fires here when a strategy picks a cell already fired at.
+         *
+         * @param side The side firing (1 or 2)
+         * @return int The cell (row * numCols + col)
+         */
+        int randomUntried(int side) { return getPlayer(side).untried_cells.sample(m_machine); }
+
+        /**
+         * @brief Check whether either side has lost every ship
+         *
+         * @return true The game is over
+         * @return false Both sides have ships left
+         */
+        bool isOver();
+
+        /**
+         * @brief Get the side which won
+         *
+         * @return int 1 or 2, or 0 while the game is still running
+         */
+        int getWinner();
+
+        /**
+         * @brief Get the side whose turn it is
+         *
+         * @return int 1 or 2
+         */
+        int getCurrentSide();
+
+        /**
+         * @brief Get the number of shots fired so far by both sides
+         *
+         * @return int The number of valid shots
+         */
+        int getRound();
+
+        /**
+         * @brief Get the number of ships per player
+         *
+         * @return int The number of ships per player
+         */
+        int getNumShips();
+
+        /**
+         * @brief Get the controller of a side
+         *
+         * @param side The side (1 or 2)
+         * @return Controller Who decides that side's moves
+         */
+        Controller getController(int side);
+
+        /**
+         * @brief Get the player for a side
+         *
+         * @param side The side (1 or 2)
+         * @return Player<BoardType>& The player
+         */
+        Player<BoardType> &getPlayer(int side);
+
+        /**
+         * @brief Get where a side's ships were placed
+         *
+         * @param side The side (1 or 2)
+         * @return const Fleet<BoardType>& The ships placed so far, by placeFleet or placeShip
+         */
+        const Fleet<BoardType> &getFleet(int side) const { return m_fleets[side - 1]; }
+
+        /**
+         * @brief Get the seed every random choice in the game is derived from
+         *
+         * @return uint64_t The seed, drawn from the clock if none was given
+         */
+        uint64_t getSeed() const { return m_seed; }
+
+    private:
+        void init(int numShips, Controller player1, Controller player2, uint64_t seed);
+
+        Player<BoardType> m_players[2];
+        Fleet<BoardType> m_fleets[2];
+        Controller m_controllers[2];
+        Machine m_machine;
+        uint64_t m_seed;
+        int m_numShips;
+        int m_round;
+};
+
+extern template class GameEngine<NormalBoard>;
+extern template class GameEngine<XLBoard>;
+
+/**
+ * @brief Let a strategy choose a shot for the current side and fire it
+ *
+ * A strategy must choose an untried cell. If it does not, that is a bug:
+ * debug builds stop, and others fire at engine.randomUntried(side) instead
+ * of asking again, since a deterministic strategy would choose the same cell.
+ *
+ * @return ShotResult The outcome, never SHOT_INVALID
+ */
+template <class BoardType, class Strategy, class OnShot>
+ShotResult playTurn(GameEngine<BoardType> &engine, Strategy &strategy, int side, OnShot &onShot)
+{
+    int cell = strategy.select(engine.getPlayer(side), engine.getPlayer(3 - side));
+    Shot shot = engine.fire(cell / BoardType::COLS, cell % BoardType::COLS);
+    if (shot.result == SHOT_INVALID)
+    {
+        assert(!"a strategy chose a cell already fired at");
+        cell = engine.randomUntried(side);
+        shot = engine.fire(cell / BoardType::COLS, cell % BoardType::COLS);
+    }
+    strategy.observe(cell, shot);
+    onShot(side, cell, shot);
+    return shot.result;
+}
+
+/**
+ * @brief Play a game whose fleets are placed to the end, side 1 with first and side 2 with second
+ *
+ * The strategies are template parameters, so there is no dispatch per
+ * shot: the sides' turns alternate in straight-line code and each strategy's
+ * calls can be inlined. The engine's own controllers are not consulted; the
+ * caller resets the strategies for the game.
+ *
+ * @param onShot Called as onShot(side, cell, shot) after every shot, with the Shot fire returned
+ * @return int The winning side
+ */
+template <class BoardType, class First, class Second, class OnShot>
+int playGame(GameEngine<BoardType> &engine, First &first, Second &second, OnShot onShot)
+{
+    while (true)
+    {
+        if (playTurn(engine, first, 1, onShot) == SHOT_WIN) return 1;
+        if (playTurn(engine, second, 2, onShot) == SHOT_WIN) return 2;
+    }
+}
+
+#endif
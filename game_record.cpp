@@ -0,0 +1,398 @@
+#include "game_record.h"
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    void putVarint(std::vector<uint8_t> &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    /**
+     * @brief Decode a varint, never reading at or past end
+     *
+     * @return true A varint was decoded and at moved past it
+     * @return false It runs past end or is longer than 64 bits
+     */
+    bool getVarint(const uint8_t *&at, const uint8_t *end, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && at < end; shift += 7)
+        {
+            uint8_t byte = *at++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) return true;
+        }
+        return false;
+    }
+
+    size_t varintSize(uint64_t value)
+    {
+        size_t size = 1;
+        for (; value >= 0x80; value >>= 7) size++;
+        return size;
+    }
+
+    uint64_t zigzag(int value) { return value < 0 ? (static_cast<uint64_t>(-(value + 1)) << 1) | 1 : static_cast<uint64_t>(value) << 1; }
+
+    int unzigzag(uint64_t value) { return value & 1 ? -static_cast<int>(value >> 1) - 1 : static_cast<int>(value >> 1); }
+
+    int boardCells(char mode) { return mode == 'X' ? XLBoard::CELLS : NormalBoard::CELLS; }
+
+    // Side 1 fires first and the sides alternate, so side 1 has fired the extra shot when the total is odd
+    uint16_t winnerShots(int winner, int numShots)
+    {
+        if (winner == 0) return 0;
+        return static_cast<uint16_t>(winner == 1 ? (numShots + 1) / 2 : numShots / 2);
+    }
+}
+
+GameRecorder::GameRecorder(GameRecordWriter &writer) : m_writer(writer), m_numShots(0)
+{
+    m_lastCell[0] = m_lastCell[1] = 0;
+    m_chunk.reserve(CHUNK_BYTES + 1024);
+}
+
+GameRecorder::~GameRecorder()
+{
+    flush();
+}
+
+template <class BoardType>
+void GameRecorder::begin(GameEngine<BoardType> &engine, long index)
+{
+    m_header.clear();
+    m_shots.clear();
+    m_numShots = 0;
+    m_lastCell[0] = m_lastCell[1] = 0;
+
+    m_summary.mode = static_cast<uint8_t>(engine.getGameMode());
+    m_summary.numShips = static_cast<uint8_t>(engine.getNumShips());
+    m_summary.controllers[0] = static_cast<uint8_t>(engine.getController(1));
+    m_summary.controllers[1] = static_cast<uint8_t>(engine.getController(2));
+    memset(m_summary.shapes, RecordSummary::NO_SHIP, sizeof(m_summary.shapes));
+
+    m_header.push_back(static_cast<uint8_t>(engine.getGameMode()));
+    m_header.push_back(static_cast<uint8_t>(engine.getNumShips()));
+    m_header.push_back(static_cast<uint8_t>(engine.getController(1)));
+    m_header.push_back(static_cast<uint8_t>(engine.getController(2)));
+    m_header.push_back(0);   // the winner, filled in by finish()
+    putVarint(m_header, static_cast<uint64_t>(index));
+    uint64_t seed = engine.getSeed();
+    for (int i = 0; i < 8; i++) m_header.push_back(static_cast<uint8_t>(seed >> (8 * i)));
+
+    for (int side = 1; side <= 2; side++)
+    {
+        const Fleet<BoardType> &fleet = engine.getFleet(side);
+        for (int ship = 1; ship <= engine.getNumShips(); ship++)
+        {
+            const char *found = fleet.direction[ship] == '\0' ? NULL : strchr(GameRecordFormat::DIRECTIONS, fleet.direction[ship]);
+            int code = found == NULL ? 0 : found - GameRecordFormat::DIRECTIONS;   // a ship never placed is recorded facing 'U'
+            putVarint(m_header, static_cast<uint64_t>(fleet.pivot[ship]));
+            m_header.push_back(static_cast<uint8_t>(code * 8 + fleet.orientation[ship]));
+            m_summary.shapes[side - 1][ship - 1] = m_header.back();
+        }
+    }
+}
+
+void GameRecorder::shot(int side, int cell, ShotResult result)
+{
+    if (result == SHOT_INVALID) return;
+    putVarint(m_shots, (zigzag(cell - m_lastCell[side - 1]) << 2) | static_cast<uint64_t>(result));
+    m_lastCell[side - 1] = cell;
+    m_numShots++;
+}
+
+void GameRecorder::finish(int winner)
+{
+    m_header[4] = static_cast<uint8_t>(winner);
+    m_summary.winner = static_cast<uint8_t>(winner);
+    m_summary.winnerShots = winnerShots(winner, m_numShots);
+    m_summary.offset = m_chunk.size();
+    m_summaries.push_back(m_summary);
+
+    uint64_t numShots = static_cast<uint64_t>(m_numShots);
+    putVarint(m_chunk, m_header.size() + varintSize(numShots) + m_shots.size());
+    m_chunk.insert(m_chunk.end(), m_header.begin(), m_header.end());
+    putVarint(m_chunk, numShots);
+    m_chunk.insert(m_chunk.end(), m_shots.begin(), m_shots.end());
+
+    if (m_chunk.size() >= CHUNK_BYTES) flush();
+}
+
+void GameRecorder::flush()
+{
+    if (m_chunk.empty()) return;
+    m_writer.append(&m_chunk[0], m_chunk.size(), &m_summaries[0], m_summaries.size());
+    m_chunk.clear();
+    m_summaries.clear();
+}
+
+GameRecordWriter::GameRecordWriter(const std::string &path) : m_path(path), m_failed(false), m_written(0)
+{
+    // A stale index would describe the old records
+    unlink(recordIndexPath(path).c_str());
+    m_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (m_fd >= 0) write(reinterpret_cast<const uint8_t *>(GameRecordFormat::MAGIC), sizeof(GameRecordFormat::MAGIC));
+}
+
+GameRecordWriter::~GameRecordWriter()
+{
+    close();
+}
+
+void GameRecordWriter::append(const uint8_t *bytes, size_t count, const RecordSummary *summaries, size_t numSummaries)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    for (size_t i = 0; i < numSummaries; i++)
+    {
+        RecordSummary summary = summaries[i];
+        summary.offset += m_written;
+        m_index.add(summary);
+    }
+    write(bytes, count);
+}
+
+bool GameRecordWriter::close()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_fd < 0) return false;
+
+    m_failed = ::close(m_fd) != 0 || m_failed;
+    m_fd = -1;
+    return !m_failed && m_index.write(recordIndexPath(m_path), m_written);
+}
+
+void GameRecordWriter::write(const uint8_t *bytes, size_t count)
+{
+    if (m_fd < 0 || m_failed) return;
+
+    while (count > 0)
+    {
+        ssize_t written = ::write(m_fd, bytes, count);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0)
+        {
+            m_failed = true;
+            return;
+        }
+        bytes += written;
+        count -= written;
+        m_written += written;
+    }
+}
+
+template <class BoardType>
+bool GameRecordView::fleet(int side, Fleet<BoardType> &fleet) const
+{
+    if ((mode == 'X') != BoardType::checkBig() || side < 1 || side > 2) return false;
+
+    const uint8_t *at = fleets;
+    fleet.numShips = numShips;
+    for (int i = 0; i < 2 * numShips; i++)
+    {
+        uint64_t pivot;
+        if (!getVarint(at, shots, pivot) || at >= shots || pivot >= static_cast<uint64_t>(BoardType::CELLS)) return false;
+        int code = *at++;
+        if (code / 8 >= static_cast<int>(sizeof(GameRecordFormat::DIRECTIONS)) - 1) return false;
+
+        if (i / numShips == side - 1)
+        {
+            int ship = i % numShips + 1;
+            fleet.pivot[ship] = static_cast<short>(pivot);
+            fleet.direction[ship] = GameRecordFormat::DIRECTIONS[code / 8];
+            fleet.orientation[ship] = static_cast<char>(code % 8);
+        }
+    }
+    return true;
+}
+
+ShotCursor::ShotCursor(const GameRecordView &record)
+    : m_at(record.shots), m_end(record.end), m_left(record.numShots), m_fired(0)
+{
+    m_lastCell[0] = m_lastCell[1] = 0;
+}
+
+bool ShotCursor::next(int &side, int &cell, ShotResult &result)
+{
+    uint64_t value;
+    if (m_left == 0 || !getVarint(m_at, m_end, value)) return false;
+
+    side = m_fired % 2 + 1;
+    cell = m_lastCell[side - 1] + unzigzag(value >> 2);
+    result = static_cast<ShotResult>(value & 3);
+    m_lastCell[side - 1] = cell;
+    m_left--;
+    m_fired++;
+    return true;
+}
+
+GameRecordReader::GameRecordReader(const std::string &path) : m_data(NULL), m_at(NULL), m_size(0), m_corrupt(false)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(GameRecordFormat::MAGIC))
+    {
+        void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const uint8_t *>(mapped);
+            m_size = info.st_size;
+            if (memcmp(m_data, GameRecordFormat::MAGIC, sizeof(GameRecordFormat::MAGIC)) != 0) m_corrupt = true;
+        }
+    }
+    ::close(fd);   // the mapping stays valid
+    rewind();
+}
+
+GameRecordReader::~GameRecordReader()
+{
+    if (m_data != NULL) munmap(const_cast<uint8_t *>(m_data), m_size);
+}
+
+void GameRecordReader::rewind()
+{
+    m_at = m_data == NULL ? NULL : m_data + sizeof(GameRecordFormat::MAGIC);
+}
+
+void GameRecordReader::seek(size_t offset)
+{
+    if (m_data == NULL) return;
+    m_at = m_data + (offset < sizeof(GameRecordFormat::MAGIC) ? sizeof(GameRecordFormat::MAGIC) : offset > m_size ? m_size : offset);
+}
+
+bool GameRecordReader::next(GameRecordView &record)
+{
+    if (!good() || m_at == m_data + m_size) return false;
+
+    const uint8_t *end = m_data + m_size;
+    const uint8_t *at = m_at;
+    uint64_t length, index, numShots;
+    record.start = at;
+    m_corrupt = true;   // until the record proves whole
+    if (!getVarint(at, end, length) || length > static_cast<uint64_t>(end - at) || length < 14) return false;
+    end = at + length;
+
+    record.mode = static_cast<char>(at[0]);
+    record.numShips = at[1];
+    record.controllers[0] = static_cast<Controller>(at[2]);
+    record.controllers[1] = static_cast<Controller>(at[3]);
+    record.winner = at[4];
+    at += 5;
+    if ((record.mode != 'N' && record.mode != 'X') || record.numShips > BoardLayers<XLBoard::CELLS>::MAX_SHIP_NUM ||
+        record.controllers[0] > EXPERT_AI || record.controllers[1] > EXPERT_AI || record.winner > 2)
+    {
+        return false;
+    }
+    if (!getVarint(at, end, index) || end - at < 8) return false;
+    record.index = static_cast<long>(index);
+    record.seed = 0;
+    for (int i = 0; i < 8; i++) record.seed |= static_cast<uint64_t>(at[i]) << (8 * i);
+    at += 8;
+
+    // Skip the fleets: a varint pivot and a byte per ship
+    record.fleets = at;
+    for (int i = 0; i < 2 * record.numShips; i++)
+    {
+        uint64_t pivot;
+        if (!getVarint(at, end, pivot) || at >= end || pivot >= static_cast<uint64_t>(boardCells(record.mode))) return false;
+        at++;
+    }
+
+    if (!getVarint(at, end, numShots) || numShots > static_cast<uint64_t>(2 * boardCells(record.mode))) return false;
+    record.numShots = static_cast<int>(numShots);
+    record.shots = at;
+    record.end = end;
+
+    m_at = end;
+    m_corrupt = false;
+    return true;
+}
+
+void GameRecordReader::summarize(const GameRecordView &record, RecordSummary &summary) const
+{
+    summary.offset = record.start - m_data;
+    summary.mode = static_cast<uint8_t>(record.mode);
+    summary.numShips = static_cast<uint8_t>(record.numShips);
+    summary.controllers[0] = static_cast<uint8_t>(record.controllers[0]);
+    summary.controllers[1] = static_cast<uint8_t>(record.controllers[1]);
+    summary.winner = static_cast<uint8_t>(record.winner);
+    summary.winnerShots = winnerShots(record.winner, record.numShots);
+
+    memset(summary.shapes, RecordSummary::NO_SHIP, sizeof(summary.shapes));
+    const uint8_t *at = record.fleets;
+    uint64_t pivot;
+    for (int i = 0; i < 2 * record.numShips && getVarint(at, record.shots, pivot) && at < record.shots; i++)
+    {
+        summary.shapes[i / record.numShips][i % record.numShips] = *at++;
+    }
+}
+
+std::string recordIndexPath(const std::string &recordPath)
+{
+    return recordPath + ".idx";
+}
+
+bool buildRecordIndex(const std::string &recordPath)
+{
+    GameRecordReader reader(recordPath);
+    RecordIndexBuilder index;
+    GameRecordView record;
+    RecordSummary summary;
+    while (reader.next(record))
+    {
+        reader.summarize(record, summary);
+        index.add(summary);
+    }
+    return reader.good() && index.write(recordIndexPath(recordPath), reader.size());
+}
+
+template <class BoardType>
+bool replayRecord(const GameRecordView &record, GameEngine<BoardType> &engine)
+{
+    for (int side = 1; side <= 2; side++)
+    {
+        Fleet<BoardType> fleet;
+        if (!record.fleet(side, fleet)) return false;
+        for (int ship = 1; ship <= fleet.numShips; ship++)
+        {
+            if (!engine.placeShip(side, ship, fleet.pivot[ship] / BoardType::COLS, fleet.pivot[ship] % BoardType::COLS,
+                                  fleet.direction[ship], fleet.orientation[ship]))
+            {
+                return false;
+            }
+        }
+    }
+
+    ShotCursor shots(record);
+    int side, cell;
+    ShotResult result;
+    int fired = 0;
+    while (shots.next(side, cell, result))
+    {
+        if (side != engine.getCurrentSide() || cell < 0 || cell >= BoardType::CELLS) return false;
+        if (engine.fire(cell / BoardType::COLS, cell % BoardType::COLS).result != result) return false;
+        fired++;
+    }
+    return fired == record.numShots && engine.getWinner() == record.winner;
+}
+
+template void GameRecorder::begin(GameEngine<NormalBoard> &engine, long index);
+template void GameRecorder::begin(GameEngine<XLBoard> &engine, long index);
+template bool GameRecordView::fleet(int side, Fleet<NormalBoard> &fleet) const;
+template bool GameRecordView::fleet(int side, Fleet<XLBoard> &fleet) const;
+template bool replayRecord(const GameRecordView &record, GameEngine<NormalBoard> &engine);
+template bool replayRecord(const GameRecordView &record, GameEngine<XLBoard> &engine);
@@ -0,0 +1,351 @@
+/*------------------------------------------------------------
+ * @Filename: game_record.h
+ * @Description: a compact binary format for finished games, appended in large writes and read back through mmap
+ ------------------------------------------------------------*/
+
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include "game_engine.h"
+#include "record_index.h"
+#include <cstddef>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ * File layout, every multi-byte integer a LEB128 varint unless noted:
+ *
+ *   file:   the 8 bytes "BSGAMES1", then records back to back
+ *   record: length of the rest of the record
+ *           byte mode ('N' or 'X'), byte number of ships,
+ *           byte controller of side 1, byte controller of side 2, byte winner (0, 1 or 2)
+ *           game index in its run
+ *           seed, 8 bytes little endian
+ *           side 1's fleet then side 2's, ships 1 to the number of ships, each:
+ *               pivot cell (row * columns + col), byte direction code * 8 + orientation
+ *           number of shots
+ *           shots, side 1 first and the sides alternating, each:
+ *               zigzag(cell - that side's previous cell, starting from 0) * 4 + outcome
+ *
+ * The outcome is the ShotResult (SHOT_MISS to SHOT_WIN), so a shot next to the
+ * same side's last one, as the AIs fire while finishing off a ship, takes one
+ * byte. A 9x9 game of five ships between two AIs takes under two hundred bytes.
+ *
+ * The writer also saves an index of the records beside them (see record_index.h).
+ */
+
+namespace GameRecordFormat
+{
+    static const char MAGIC[8] = {'B', 'S', 'G', 'A', 'M', 'E', 'S', '1'};
+    static const char DIRECTIONS[] = "UDLRVN";   // direction codes, in order
+}
+
+class GameRecordWriter;
+
+/**
+ * @brief Encodes finished games into records and hands them to a GameRecordWriter in large chunks
+ *
+ * One recorder belongs to one thread. A game is begun once both fleets are
+ * down, each valid shot is added as it is fired, and finish() turns it into a
+ * record. Records pile up in the recorder until a chunk is full, so the
+ * writer's lock and the write() it makes are paid once per several hundred
+ * games.
+ */
+class GameRecorder
+{
+    public:
+        static const size_t CHUNK_BYTES = 1 << 16;
+
+        /**
+         * @brief Construct a recorder
+         *
+         * @param writer Where to send full chunks
+         */
+        explicit GameRecorder(GameRecordWriter &writer);
+
+        /**
+         * @brief Send whatever records are left
+         *
+         */
+        ~GameRecorder();
+
+        /**
+         * @brief Start a game whose fleets have been placed
+         *
+         * @param engine The game
+         * @param index The game's index in its run
+         */
+        template <class BoardType>
+        void begin(GameEngine<BoardType> &engine, long index);
+
+        /**
+         * @brief Add the shot just fired
+         *
+         * @param side The side which fired (1 or 2)
+         * @param cell The cell fired at, row * columns + col
+         * @param result The outcome; SHOT_INVALID shots are not recorded
+         */
+        void shot(int side, int cell, ShotResult result);
+
+        /**
+         * @brief Finish the game and queue its record
+         *
+         * @param winner The side which won, or 0 if the game was stopped
+         */
+        void finish(int winner);
+
+        /**
+         * @brief Send the queued records to the writer now
+         *
+         */
+        void flush();
+
+    private:
+        GameRecordWriter &m_writer;
+        std::vector<uint8_t> m_header;   // the record up to the shot count
+        std::vector<uint8_t> m_shots;
+        std::vector<uint8_t> m_chunk;    // finished records waiting for the writer
+        RecordSummary m_summary;         // of the game being recorded
+        std::vector<RecordSummary> m_summaries;   // of the records in m_chunk, offsets from its start
+        int m_numShots;
+        int m_lastCell[2];
+};
+
+/**
+ * @brief Appends records to a game-record file and saves their index when closed
+ *
+ * Shared by every thread of a run; each append is one write() of a whole chunk
+ * under a lock, so records from different threads never interleave. The
+ * summaries of the records are kept, in file order, until close() writes them
+ * out as the index.
+ */
+class GameRecordWriter
+{
+    public:
+        /**
+         * @brief Create (or truncate) a file and write its magic
+         *
+         * @param path The file
+         */
+        explicit GameRecordWriter(const std::string &path);
+
+        /**
+         * @brief Close the file, if close() has not
+         *
+         */
+        ~GameRecordWriter();
+
+        /**
+         * @brief Check whether the file opened and every write so far succeeded
+         *
+         */
+        bool good() const { return m_fd >= 0 && !m_failed; }
+
+        /**
+         * @brief Append whole records
+         *
+         * @param bytes The records
+         * @param count The number of bytes
+         * @param summaries The records' summaries, offsets counted from bytes
+         * @param numSummaries The number of records
+         */
+        void append(const uint8_t *bytes, size_t count, const RecordSummary *summaries, size_t numSummaries);
+
+        /**
+         * @brief Close the file and write its index
+         *
+         * @return true Every record and the index were written
+         * @return false Something failed; the index is not written
+         */
+        bool close();
+
+    private:
+        GameRecordWriter(const GameRecordWriter &);
+        GameRecordWriter &operator=(const GameRecordWriter &);
+
+        /**
+         * @brief Write bytes at the end of the file; the lock must be held
+         *
+         */
+        void write(const uint8_t *bytes, size_t count);
+
+        std::mutex m_lock;
+        std::string m_path;
+        int m_fd;
+        bool m_failed;
+        uint64_t m_written;
+        RecordIndexBuilder m_index;
+};
+
+/**
+ * @brief One record, pointing into the mapped file
+ *
+ * The fixed fields are decoded by GameRecordReader::next(); the fleets and
+ * shots are decoded on demand from the mapped bytes, nothing is copied.
+ */
+struct GameRecordView
+{
+    char mode;
+    int numShips;
+    Controller controllers[2];
+    int winner;
+    long index;
+    uint64_t seed;
+    int numShots;
+    const uint8_t *start;      // the record's first byte
+    const uint8_t *fleets;     // the fleets, as laid out in the file
+    const uint8_t *shots;      // the shots, as laid out in the file
+    const uint8_t *end;        // one past the record
+
+    /**
+     * @brief Decode one side's fleet
+     *
+     * @param side The side (1 or 2)
+     * @param fleet Set to the fleet; BoardType must match mode
+     * @return true The fleet was decoded
+     * @return false The record is corrupt or the board type is wrong
+     */
+    template <class BoardType>
+    bool fleet(int side, Fleet<BoardType> &fleet) const;
+};
+
+/**
+ * @brief Walks through the shots of a record, in the order they were fired
+ *
+ */
+class ShotCursor
+{
+    public:
+        explicit ShotCursor(const GameRecordView &record);
+
+        /**
+         * @brief Decode the next shot
+         *
+         * @param side Set to the side which fired
+         * @param cell Set to the cell fired at
+         * @param result Set to the outcome
+         * @return true A shot was decoded
+         * @return false Every shot has been read, or the record is corrupt
+         */
+        bool next(int &side, int &cell, ShotResult &result);
+
+    private:
+        const uint8_t *m_at;
+        const uint8_t *m_end;
+        int m_left;
+        int m_fired;
+        int m_lastCell[2];
+};
+
+/**
+ * @brief Maps a game-record file read-only and iterates its records in place
+ *
+ * The file is mapped once, so a file of many gigabytes costs address space
+ * rather than memory, and the kernel reads ahead as the records are walked.
+ */
+class GameRecordReader
+{
+    public:
+        /**
+         * @brief Map a file
+         *
+         * @param path The file
+         */
+        explicit GameRecordReader(const std::string &path);
+
+        /**
+         * @brief Unmap the file
+         *
+         */
+        ~GameRecordReader();
+
+        /**
+         * @brief Check whether the file mapped, has the magic, and no corrupt record has been met
+         *
+         */
+        bool good() const { return m_data != NULL && !m_corrupt; }
+
+        /**
+         * @brief Read the next record
+         *
+         * @param record Set to the record
+         * @return true A record was read
+         * @return false The end of the file, or a corrupt record (good() is then false)
+         */
+        bool next(GameRecordView &record);
+
+        /**
+         * @brief Go back to the first record
+         *
+         */
+        void rewind();
+
+        /**
+         * @brief Jump to the record at a byte offset, as given by offset()
+         *
+         * @param offset The offset of a record's first byte
+         */
+        void seek(size_t offset);
+
+        /**
+         * @brief Get the byte offset of the record next() would read
+         *
+         */
+        size_t offset() const { return m_at - m_data; }
+
+        /**
+         * @brief Get the size of the file in bytes
+         *
+         */
+        size_t size() const { return m_size; }
+
+        /**
+         * @brief Summarise a record for the index
+         *
+         * @param record The record, read from this file
+         * @param summary Set to its summary
+         */
+        void summarize(const GameRecordView &record, RecordSummary &summary) const;
+
+    private:
+        GameRecordReader(const GameRecordReader &);
+        GameRecordReader &operator=(const GameRecordReader &);
+
+        const uint8_t *m_data;
+        const uint8_t *m_at;
+        size_t m_size;
+        bool m_corrupt;
+};
+
+/**
+ * @brief Get where the index of a record file is kept
+ *
+ */
+std::string recordIndexPath(const std::string &recordPath);
+
+/**
+ * @brief Build the index of a record file by reading every record, as the writer would have
+ *
+ * @param recordPath The record file
+ * @return true The index was written
+ * @return false The records could not be read whole, or the index could not be written
+ */
+bool buildRecordIndex(const std::string &recordPath);
+
+/**
+ * @brief Play a recorded game again through a GameEngine, as it was played live
+ *
+ * The ships are placed with placeShip and the shots fired with fire, so the
+ * boards end up as they did in the recorded game.
+ *
+ * @param record The record
+ * @param engine A new engine for record.numShips ships, on the board of record.mode
+ * @return true Every ship went down and every shot had its recorded outcome
+ * @return false The game played out differently, or the record is corrupt
+ */
+template <class BoardType>
+bool replayRecord(const GameRecordView &record, GameEngine<BoardType> &engine);
+
+#endif
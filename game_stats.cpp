@@ -0,0 +1,248 @@
+#include "game_stats.h"
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+RunningMoments::RunningMoments()
+    : m_count(0), m_mean(0), m_m2(0),
+      m_min(std::numeric_limits<double>::infinity()), m_max(-std::numeric_limits<double>::infinity()) {}
+
+void RunningMoments::add(double value)
+{
+    m_count++;
+    double delta = value - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (value - m_mean);
+    if (value < m_min) m_min = value;
+    if (value > m_max) m_max = value;
+}
+
+void RunningMoments::merge(const RunningMoments &other)
+{
+    if (other.m_count == 0) return;
+    if (m_count == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    uint64_t count = m_count + other.m_count;
+    double delta = other.m_mean - m_mean;
+    m_mean += delta * other.m_count / count;
+    m_m2 += other.m_m2 + delta * delta * (static_cast<double>(m_count) * other.m_count / count);
+    m_count = count;
+    if (other.m_min < m_min) m_min = other.m_min;
+    if (other.m_max > m_max) m_max = other.m_max;
+}
+
+double RunningMoments::stddev() const { return std::sqrt(variance()); }
+
+template <class BoardType>
+void GameOutcome<BoardType>::reset()
+{
+    winner = 0;
+    for (int side = 0; side < 2; side++)
+    {
+        shots[side] = 0;
+        firstHit[side] = -1;
+        for (int ship = 0; ship <= MAX_SHIP_NUM; ship++) sinkShot[side][ship] = 0;
+    }
+}
+
+template <class BoardType>
+void GameOutcome<BoardType>::shot(int side, int cell, ShotResult result, int sunkShip)
+{
+    if (result == SHOT_INVALID) return;
+    int s = side - 1;
+    shots[s]++;
+    if (result != SHOT_MISS && firstHit[s] < 0) firstHit[s] = cell;
+    if ((result == SHOT_SUNK || result == SHOT_WIN) && sunkShip > 0) sinkShot[s][sunkShip] = shots[s];
+}
+
+template <class BoardType>
+GameStats<BoardType>::GameStats() : m_games(0)
+{
+    for (int side = 0; side < 2; side++)
+    {
+        m_wins[side] = 0;
+        for (int cell = 0; cell < BoardType::CELLS; cell++) m_firstHits[side][cell] = 0;
+    }
+}
+
+template <class BoardType>
+void GameStats<BoardType>::add(const GameOutcome<BoardType> &game)
+{
+    m_games++;
+    if (game.winner != 0)
+    {
+        int winner = game.winner - 1;
+        m_wins[winner]++;
+        m_shotsToWin[winner].add(game.shots[winner]);
+        m_shotsHistogram[winner].add(game.shots[winner]);
+    }
+    for (int side = 0; side < 2; side++)
+    {
+        if (game.firstHit[side] >= 0) m_firstHits[side][game.firstHit[side]]++;
+        for (int ship = 1; ship <= MAX_SHIP_NUM; ship++)
+        {
+            if (game.sinkShot[side][ship] > 0) m_timeToSink[side][ship].add(game.sinkShot[side][ship]);
+        }
+    }
+}
+
+template <class BoardType>
+void GameStats<BoardType>::merge(const GameStats &other)
+{
+    m_games += other.m_games;
+    for (int side = 0; side < 2; side++)
+    {
+        m_wins[side] += other.m_wins[side];
+        m_shotsToWin[side].merge(other.m_shotsToWin[side]);
+        m_shotsHistogram[side].merge(other.m_shotsHistogram[side]);
+        for (int ship = 1; ship <= MAX_SHIP_NUM; ship++) m_timeToSink[side][ship].merge(other.m_timeToSink[side][ship]);
+        for (int cell = 0; cell < BoardType::CELLS; cell++) m_firstHits[side][cell] += other.m_firstHits[side][cell];
+    }
+}
+
+namespace
+{
+    void printShotsRow(std::ostream &out, const std::string &name, uint64_t wins, uint64_t games,
+                       const RunningMoments &moments, int p10, int p50, int p90)
+    {
+        out << std::left << std::setw(14) << name << std::right
+            << std::setw(9) << wins << std::setw(8) << std::fixed << std::setprecision(2)
+            << (games == 0 ? 0.0 : 100.0 * wins / games) << "%";
+        if (moments.count() == 0)
+        {
+            out << "\n";
+            return;
+        }
+        out << std::setw(8) << moments.mean() << std::setw(8) << moments.stddev()
+            << std::setw(6) << static_cast<int>(moments.min()) << std::setw(6) << p10 << std::setw(6) << p50
+            << std::setw(6) << p90 << std::setw(6) << static_cast<int>(moments.max()) << "\n";
+    }
+
+    void writeMomentsJson(std::ostream &out, const RunningMoments &moments)
+    {
+        out << "\"count\": " << moments.count();
+        if (moments.count() == 0) return;
+        out << ", \"mean\": " << moments.mean() << ", \"stddev\": " << moments.stddev()
+            << ", \"min\": " << moments.min() << ", \"max\": " << moments.max();
+    }
+}
+
+template <class BoardType>
+void GameStats<BoardType>::print(std::ostream &out, const char *const names[2]) const
+{
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    Histogram<BoardType::CELLS + 1> allShots = m_shotsHistogram[0];
+    allShots.merge(m_shotsHistogram[1]);
+    RunningMoments allMoments = m_shotsToWin[0];
+    allMoments.merge(m_shotsToWin[1]);
+
+    out << "              " << std::setw(9) << "wins" << std::setw(9) << "win%"
+        << std::setw(8) << "mean" << std::setw(8) << "stddev" << std::setw(6) << "min" << std::setw(6) << "p10"
+        << std::setw(6) << "p50" << std::setw(6) << "p90" << std::setw(6) << "max" << "   (shots to win)\n";
+    for (int side = 0; side < 2; side++)
+    {
+        const Histogram<BoardType::CELLS + 1> &shots = m_shotsHistogram[side];
+        printShotsRow(out, names[side], m_wins[side], m_games, m_shotsToWin[side],
+                      shots.percentile(0.10), shots.percentile(0.50), shots.percentile(0.90));
+    }
+    printShotsRow(out, "all", m_wins[0] + m_wins[1], m_games, allMoments,
+                  allShots.percentile(0.10), allShots.percentile(0.50), allShots.percentile(0.90));
+
+    out << "time to sink (mean shots by the side which sank it):\n";
+    out << std::left << std::setw(14) << "ship" << std::right;
+    for (int side = 0; side < 2; side++) out << std::setw(16) << names[side];
+    out << "\n";
+    for (int ship = 1; ship <= MAX_SHIP_NUM; ship++)
+    {
+        if (m_timeToSink[0][ship].count() == 0 && m_timeToSink[1][ship].count() == 0) continue;
+        out << std::left << std::setw(14) << ship << std::right;
+        for (int side = 0; side < 2; side++)
+        {
+            if (m_timeToSink[side][ship].count() == 0) out << std::setw(16) << "-";
+            else out << std::setw(16) << m_timeToSink[side][ship].mean();
+        }
+        out << "\n";
+    }
+
+    out << "first hit, most often at:";
+    for (int side = 0; side < 2; side++)
+    {
+        int best = 0;
+        for (int cell = 1; cell < BoardType::CELLS; cell++)
+        {
+            if (m_firstHits[side][cell] > m_firstHits[side][best]) best = cell;
+        }
+        uint64_t hits = 0;
+        for (int cell = 0; cell < BoardType::CELLS; cell++) hits += m_firstHits[side][cell];
+        out << "  " << names[side] << " ";
+        if (hits == 0) out << "-";
+        else out << "row " << best / BoardType::COLS + 1 << " col " << best % BoardType::COLS + 1
+                 << " (" << 100.0 * m_firstHits[side][best] / hits << "%)";
+    }
+    out << "\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+template <class BoardType>
+void GameStats<BoardType>::writeJson(std::ostream &out) const
+{
+    std::streamsize precision = out.precision(10);
+
+    out << "{\"games\": " << m_games << ", \"sides\": [";
+    for (int side = 0; side < 2; side++)
+    {
+        const Histogram<BoardType::CELLS + 1> &shots = m_shotsHistogram[side];
+        out << (side == 0 ? "\n  " : ",\n  ") << "{\"side\": " << side + 1 << ", \"wins\": " << m_wins[side]
+            << ", \"win_rate\": " << (m_games == 0 ? 0.0 : static_cast<double>(m_wins[side]) / m_games);
+
+        out << ",\n   \"shots_to_win\": {";
+        writeMomentsJson(out, m_shotsToWin[side]);
+        out << ", \"p10\": " << shots.percentile(0.10) << ", \"p50\": " << shots.percentile(0.50)
+            << ", \"p90\": " << shots.percentile(0.90) << ", \"histogram\": [";
+        int last = BoardType::CELLS;
+        while (last > 0 && shots.count(last) == 0) last--;
+        for (int i = 0; i <= last; i++) out << (i == 0 ? "" : ", ") << shots.count(i);
+        out << "]}";
+
+        out << ",\n   \"time_to_sink\": [";
+        bool first = true;
+        for (int ship = 1; ship <= MAX_SHIP_NUM; ship++)
+        {
+            if (m_timeToSink[side][ship].count() == 0) continue;
+            out << (first ? "" : ", ") << "{\"ship\": " << ship << ", ";
+            writeMomentsJson(out, m_timeToSink[side][ship]);
+            out << "}";
+            first = false;
+        }
+        out << "]";
+
+        out << ",\n   \"first_hits\": [";
+        for (int row = 0; row < BoardType::ROWS; row++)
+        {
+            out << (row == 0 ? "[" : ", [");
+            for (int col = 0; col < BoardType::COLS; col++)
+            {
+                out << (col == 0 ? "" : ", ") << m_firstHits[side][row * BoardType::COLS + col];
+            }
+            out << "]";
+        }
+        out << "]}";
+    }
+    out << "\n]}";
+
+    out.precision(precision);
+}
+
+template struct GameOutcome<NormalBoard>;
+template struct GameOutcome<XLBoard>;
+template class GameStats<NormalBoard>;
+template class GameStats<XLBoard>;
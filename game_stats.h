@@ -0,0 +1,180 @@
+/*------------------------------------------------------------
+ * @Filename: game_stats.h
+ * @Description: streaming statistics over many games, accumulated per thread and merged at the end
+ ------------------------------------------------------------*/
+
+#ifndef GAME_STATS_H
+#define GAME_STATS_H
+
+#include "board.h"
+#include "game_engine.h"
+#include <ostream>
+#include <stdint.h>
+
+/**
+ * @brief Count, mean, variance, min and max of a stream of values, in constant space
+ *
+ * Uses Welford's update, and Chan's formula to merge two streams, so the
+ * result does not depend on how the games were split between threads beyond
+ * rounding.
+ */
+class RunningMoments
+{
+    public:
+        RunningMoments();
+
+        void add(double value);
+
+        void merge(const RunningMoments &other);
+
+        uint64_t count() const { return m_count; }
+        double mean() const { return m_mean; }
+        double min() const { return m_min; }
+        double max() const { return m_max; }
+
+        /**
+         * @brief Get the sample variance
+         *
+         * @return double The variance, or 0 for fewer than two values
+         */
+        double variance() const { return m_count < 2 ? 0.0 : m_m2 / (m_count - 1); }
+
+        double stddev() const;
+
+    private:
+        uint64_t m_count;
+        double m_mean;
+        double m_m2;   // the sum of squared differences from the mean
+        double m_min;
+        double m_max;
+};
+
+/**
+ * @brief Counts of whole values in [0, Buckets), one bucket each; larger values go in the last bucket
+ *
+ */
+template <int Buckets>
+class Histogram
+{
+    public:
+        Histogram() { for (int i = 0; i < Buckets; i++) m_counts[i] = 0; }
+
+        void add(int value) { m_counts[value < 0 ? 0 : value >= Buckets ? Buckets - 1 : value]++; }
+
+        void merge(const Histogram &other) { for (int i = 0; i < Buckets; i++) m_counts[i] += other.m_counts[i]; }
+
+        uint64_t count(int bucket) const { return m_counts[bucket]; }
+
+        uint64_t total() const
+        {
+            uint64_t sum = 0;
+            for (int i = 0; i < Buckets; i++) sum += m_counts[i];
+            return sum;
+        }
+
+        /**
+         * @brief Find the smallest value at or above a fraction of the counts
+         *
+         * @param fraction From 0 to 1
+         * @return int The value, or 0 if nothing was counted
+         */
+        int percentile(double fraction) const
+        {
+            uint64_t target = static_cast<uint64_t>(fraction * total());
+            uint64_t seen = 0;
+            for (int i = 0; i < Buckets; i++)
+            {
+                seen += m_counts[i];
+                if (seen > target) return i;
+            }
+            return 0;
+        }
+
+    private:
+        uint64_t m_counts[Buckets];
+};
+
+/**
+ * @brief What happened in one game, filled in shot by shot by the loop playing it
+ *
+ */
+template <class BoardType>
+struct GameOutcome
+{
+    static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+
+    int winner;
+    int shots[2];                          // fired by each side
+    int firstHit[2];                       // the cell of each side's first hit, or -1
+    int sinkShot[2][MAX_SHIP_NUM + 1];     // the shot of each side which sank each enemy ship, or 0
+
+    GameOutcome() { reset(); }
+
+    void reset();
+
+    /**
+     * @brief Add a shot
+     *
+     * @param side The side which fired (1 or 2)
+     * @param cell The cell fired at
+     * @param result The outcome; SHOT_INVALID shots are ignored
+     * @param sunkShip The ship the shot sank, if it sank one
+     */
+    void shot(int side, int cell, ShotResult result, int sunkShip);
+};
+
+/**
+ * @brief Win rates, shots to win, time to sink each ship and where first hits land, over many games
+ *
+ * One GameStats per worker thread is fed after each game; when the run is
+ * over the workers' copies are merged on one thread, so nothing is shared or
+ * locked while games are played.
+ */
+template <class BoardType>
+class GameStats
+{
+    public:
+        static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+
+        GameStats();
+
+        /**
+         * @brief Add a finished game
+         *
+         */
+        void add(const GameOutcome<BoardType> &game);
+
+        void merge(const GameStats &other);
+
+        uint64_t games() const { return m_games; }
+
+        /**
+         * @brief Print a table of the results
+         *
+         * @param out Where to print
+         * @param names What to call each side, e.g. "side 1 (H)"
+         */
+        void print(std::ostream &out, const char *const names[2]) const;
+
+        /**
+         * @brief Write the results as one JSON object
+         *
+         * @param out Where to write
+         */
+        void writeJson(std::ostream &out) const;
+
+    private:
+        uint64_t m_games;
+        uint64_t m_wins[2];
+        RunningMoments m_shotsToWin[2];                       // by the side which won
+        Histogram<BoardType::CELLS + 1> m_shotsHistogram[2];
+        RunningMoments m_timeToSink[2][MAX_SHIP_NUM + 1];     // by the side which fired and the ship it sank
+        uint64_t m_firstHits[2][BoardType::CELLS];
+};
+
+extern template struct GameOutcome<NormalBoard>;
+extern template struct GameOutcome<XLBoard>;
+extern template class GameStats<NormalBoard>;
+extern template class GameStats<XLBoard>;
+
+#endif
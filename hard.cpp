@@ -0,0 +1,133 @@
+//HARD CPP
+
+#include "hard.h"
+
+template <class BoardType>
+Hard<BoardType>::Hard() {
+    for (int length = 0; length <= BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM; length++) {
+        m_numShapes[length] = ShipShape<BoardType>::variants(length, m_shapes[length]);
+    }
+}
+
+template <class BoardType>
+void Hard<BoardType>::seed(uint64_t seedValue, uint64_t stream) { machine.seed(seedValue, stream); }
+
+template <class BoardType>
+void Hard<BoardType>::addCells(const Mask &cells) {
+    // Ripple-carry add of a one-bit number into every cell's count at once
+    Mask carry = cells;
+    for (int plane = 0; plane < COUNT_PLANES && carry.any(); plane++) {
+        Mask next = m_counts[plane] & carry;
+        m_counts[plane] ^= carry;
+        carry = next;
+    }
+}
+
+template <class BoardType>
+void Hard<BoardType>::addPlacements(const Mask &corners, const ShipShape<BoardType> &shape) {
+    if (!corners.any()) {
+        return;
+    }
+    for (int k = 0; k < shape.getNumCells(); k++) {
+        addCells(corners << shape.getOffset(k));
+    }
+}
+
+template <class BoardType>
+void Hard<BoardType>::countPlacements(const Mask &free, const Mask &through, const bool floating[], int numShips) {
+    for (int plane = 0; plane < COUNT_PLANES; plane++) {
+        m_counts[plane].clear();
+    }
+
+    bool targeting = through.any();
+    for (int length = 1; length <= numShips; length++) {
+        if (!floating[length]) {
+            continue;
+        }
+
+        for (int v = 0; v < m_numShapes[length]; v++) {
+            const ShipShape<BoardType> &shape = *m_shapes[length][v];
+            Mask corners = shape.legalCorners(free);
+            if (targeting && corners.any()) {
+                corners &= shape.covering(through);
+            }
+            addPlacements(corners, shape);
+        }
+    }
+}
+
+template <class BoardType>
+typename Hard<BoardType>::Mask Hard<BoardType>::highest(Mask candidates) const {
+    for (int plane = COUNT_PLANES - 1; plane >= 0; plane--) {
+        Mask withBit = candidates & m_counts[plane];
+        if (withBit.any()) {
+            candidates = withBit;
+        }
+    }
+    return candidates;
+}
+
+template <class BoardType>
+int Hard<BoardType>::chooseShot(Player<BoardType> &attacker, Player<BoardType> &defender) {
+    return chooseShot(enemyView(attacker, defender));
+}
+
+template <class BoardType>
+int Hard<BoardType>::chooseShot(const EnemyView<BoardType> &view) {
+    const int numShips = view.numShips;
+    bool floating[BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM + 1] = {false};
+    for (int ship = 1; ship <= numShips; ship++) {
+        floating[ship] = !((view.sunkShips >> ship) & 1);
+    }
+
+    const Mask &sunkCells = view.sunk;
+    const Mask &hits = view.hits;
+    const Mask &misses = view.misses;
+    Mask untried = Mask::full().andNot(hits | misses);
+    Mask free = Mask::full().andNot(misses | sunkCells);
+    Mask openHits = hits.andNot(sunkCells);
+
+    if (INCREMENTAL_HUNT) {
+        m_heatmap.sync(hits, misses, sunkCells, floating, numShips);
+    }
+
+    TranspositionTable<BoardType> &table = TranspositionTable<BoardType>::shared();
+    bool keep = (openHits.any() || !INCREMENTAL_HUNT) && (hits | misses).count() <= OPENING_SHOTS;
+    uint64_t key = keep ? positionKey(view.marks, sunkCells, floating, numShips) : 0;
+
+    Mask best;
+    if (!keep || !table.find(key, best)) {
+        if (openHits.any()) {
+            // Target mode: finish off the ship(s) already hit
+            countPlacements(free, openHits, floating, numShips);
+            Mask counted;
+            for (int plane = 0; plane < COUNT_PLANES; plane++) {
+                counted |= m_counts[plane];
+            }
+            best = highest(untried & counted);
+        }
+        if (!best.any()) {
+            // Hunt mode: no hits to follow up, or none of them can be extended
+            if (INCREMENTAL_HUNT) {
+                int cell = m_heatmap.best();
+                if (cell >= 0) {
+                    return cell;
+                }
+            } else {
+                countPlacements(free, Mask(), floating, numShips);
+                best = highest(untried);
+            }
+        }
+        if (!best.any()) {
+            best = untried;
+        }
+        if (keep) {
+            table.store(key, best);
+        }
+    }
+
+    return best.nth(machine.randomBelow(best.count()));
+}
+
+template class Hard<NormalBoard>;
+template class Hard<XLBoard>;
@@ -0,0 +1,121 @@
+//HARD H
+
+#ifndef HARD_H
+#define HARD_H
+
+#include "player.h"
+#include "machine.h"
+#include "heatmap.h"
+#include "placement.h"
+#include "transposition.h"
+
+/**
+ * @brief The hard difficulty AI: fires at the cell the most possible ship placements cover
+ *
+ * Only the attacker's own view of the enemy board is used, plus which of the
+ * enemy's ships have been sunk (the game announces a ship when it sinks, and
+ * its cells are then known). Each turn every placement of every floating ship
+ * which avoids the misses and the sunk ships is counted per cell. While some
+ * hits do not belong to a sunk ship, only placements through one of those hits
+ * are counted.
+ *
+ * The placements are never listed one by one. For each shape a ship can take
+ * (ShipShape::variants, so bent ships count the same way as straight ones) the
+ * legal corners are the AND of the free mask shifted by each cell's offset, and
+ * the cells each placement covers are that corner mask shifted back again. Those
+ * masks are summed into per-cell counts held as bit planes (m_counts[i] is bit
+ * i of every cell's count), and the highest count is found by walking the
+ * planes from the top.
+ *
+ * With no open hits to follow up (hunt mode) the counts are the same every
+ * turn apart from the last shot. On the XL board they come from an
+ * incremental Heatmap instead, and ties go to whichever cell the heatmap
+ * lists first. A 9x9 mask is two words, and recounting it is cheaper than
+ * the heatmap's per-cell bookkeeping.
+ *
+ * The cells found best depend on nothing but the position: the hits, the
+ * misses, the sunk ships and which ships float. They are kept in the process's
+ * TranspositionTable under the position's Zobrist hash, so a position already
+ * met in another game costs a lookup; only the tie-break is drawn afresh.
+ * Every game opens the same way, so only positions within OPENING_SHOTS shots
+ * are kept. The XL hunt is not kept either, as the heatmap breaks ties by the
+ * order of earlier shots rather than by the position.
+ */
+template <class BoardType>
+class Hard{
+
+    public:
+        /**
+         * @brief Construct a new Hard AI
+         *
+         */
+        Hard();
+
+        /**
+         * @brief Restart the AI's random sequence, used to break ties between equally likely cells
+         *
+         * @param seedValue The seed
+         * @param stream The stream id
+         */
+        void seed(uint64_t seedValue, uint64_t stream);
+
+        /**
+         * @brief Choose where to fire next. Does not fire.
+         *
+         * @param attacker The AI's player
+         * @param defender The player being fired at; only its sunk ships are looked at
+         * @return int The cell to fire at (row * numCols + col)
+         */
+        int chooseShot(Player<BoardType> &attacker, Player<BoardType> &defender);
+
+        /**
+         * @brief Choose where to fire next from what the attacker knows alone; the same choice as above
+         *
+         * @param view The attacker's marks on the enemy board and the ships it has sunk
+         * @return int The cell to fire at (row * numCols + col)
+         */
+        int chooseShot(const EnemyView<BoardType> &view);
+
+    private:
+        typedef typename BoardType::Mask Mask;
+
+        static const int COUNT_PLANES = 8;
+        static const bool INCREMENTAL_HUNT = Mask::WORDS > 2;
+        static const int OPENING_SHOTS = 12;   // later positions rarely repeat, and would only crowd the table
+
+        /**
+         * @brief Add one to the count of every cell covered by a placement of each corner in corners
+         *
+         * @param corners The corner of each placement
+         * @param shape The shape placed
+         */
+        void addPlacements(const Mask &corners, const ShipShape<BoardType> &shape);
+
+        /**
+         * @brief Add one to the count of every cell in cells
+         *
+         */
+        void addCells(const Mask &cells);
+
+        /**
+         * @brief Count the placements of every floating ship, restricted to those through a hit in through if it is not empty
+         *
+         */
+        void countPlacements(const Mask &free, const Mask &through, const bool floating[], int numShips);
+
+        /**
+         * @brief Narrow candidates down to the cells with the highest count
+         *
+         */
+        Mask highest(Mask candidates) const;
+
+        const ShipShape<BoardType> *m_shapes[BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM + 1][ShipShape<BoardType>::MAX_VARIANTS];  // by length
+        int m_numShapes[BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM + 1];
+        Mask m_counts[COUNT_PLANES];
+        Heatmap<BoardType> m_heatmap;
+        Machine machine;
+};
+
+extern template class Hard<NormalBoard>;
+extern template class Hard<XLBoard>;
+#endif
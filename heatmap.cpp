@@ -0,0 +1,218 @@
+#include "heatmap.h"
+#include "stats.h"
+#include <vector>
+
+template <class BoardType>
+Heatmap<BoardType>::Heatmap()
+{
+    m_numShips = 0;
+    m_max = 0;
+    m_ready = false;
+    for (int length = 0; length <= MAX_SHIP_NUM; length++)
+    {
+        m_numShapes[length] = ShipShape<BoardType>::variants(length, m_shapes[length]);
+    }
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::link(int cell)
+{
+    int count = m_count[cell];
+    m_prev[cell] = -1;
+    m_next[cell] = m_head[count];
+    if (m_head[count] >= 0) m_prev[m_head[count]] = static_cast<short>(cell);
+    m_head[count] = static_cast<short>(cell);
+    if (count > m_max) m_max = count;
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::unlink(int cell)
+{
+    if (m_prev[cell] >= 0) m_next[m_prev[cell]] = m_next[cell];
+    else m_head[m_count[cell]] = m_next[cell];
+    if (m_next[cell] >= 0) m_prev[m_next[cell]] = m_prev[cell];
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::drop(int corner, const ShipShape<BoardType> &shape)
+{
+    STATS_ADD(HEATMAP_CELLS_UPDATED, shape.getNumCells());
+    for (int k = 0; k < shape.getNumCells(); k++)
+    {
+        int cell = corner + shape.getOffset(k);
+        if (!m_touched.test(cell))
+        {
+            // Take the cell out of its bucket once, before its count first changes
+            m_touched.set(cell);
+            if (!m_fired.test(cell)) unlink(cell);
+        }
+        m_count[cell]--;
+    }
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::relinkTouched()
+{
+    Mask touched = m_touched.andNot(m_fired);
+    for (int cell = touched.first(); cell >= 0; cell = touched.first())
+    {
+        touched.reset(cell);
+        link(cell);
+    }
+    m_touched.clear();
+}
+
+template <class BoardType>
+const Heatmap<BoardType> &Heatmap<BoardType>::fresh(int numShips)
+{
+    // Built once per board size and shared by every thread (function statics are initialised exactly once)
+    static const std::vector<Heatmap> fleets = []() {
+        std::vector<Heatmap> built(MAX_SHIP_NUM + 1);
+        bool all[MAX_SHIP_NUM + 1];
+        for (int length = 0; length <= MAX_SHIP_NUM; length++) all[length] = true;
+        for (int numShips = 1; numShips <= MAX_SHIP_NUM; numShips++) built[numShips].count(all, numShips);
+        return built;
+    }();
+    return fleets[numShips];
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::reset(const bool floating[], int numShips)
+{
+    bool allFloating = true;
+    for (int length = 1; length <= numShips; length++) allFloating = allFloating && floating[length];
+    if (allFloating)
+    {
+        *this = fresh(numShips);
+    }
+    else
+    {
+        count(floating, numShips);
+    }
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::count(const bool floating[], int numShips)
+{
+    m_numShips = numShips;
+    m_blocked.clear();
+    m_fired.clear();
+    for (int cell = 0; cell < BoardType::CELLS; cell++) m_count[cell] = 0;
+
+    for (int length = 1; length <= MAX_SHIP_NUM; length++)
+    {
+        m_floating[length] = length <= numShips && floating[length];
+        for (int v = 0; v < MAX_VARIANTS; v++) m_starts[length][v].clear();
+        if (!m_floating[length]) continue;
+
+        for (int v = 0; v < m_numShapes[length]; v++)
+        {
+            const ShipShape<BoardType> &shape = *m_shapes[length][v];
+            m_starts[length][v] = shape.legalCorners(Mask::full());
+            Mask corners = m_starts[length][v];
+            for (int corner = corners.first(); corner >= 0; corner = corners.first())
+            {
+                corners.reset(corner);
+                for (int k = 0; k < shape.getNumCells(); k++) m_count[corner + shape.getOffset(k)]++;
+            }
+        }
+    }
+
+    for (int count = 0; count <= MAX_COUNT; count++) m_head[count] = -1;
+    m_max = 0;
+    for (int cell = BoardType::CELLS - 1; cell >= 0; cell--) link(cell);
+    m_ready = true;
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::block(int cell)
+{
+    if (m_blocked.test(cell)) return;
+    m_blocked.set(cell);
+
+    for (int length = 1; length <= m_numShips; length++)
+    {
+        if (!m_floating[length]) continue;
+        for (int v = 0; v < m_numShapes[length]; v++)
+        {
+            const ShipShape<BoardType> &shape = *m_shapes[length][v];
+            for (int k = 0; k < shape.getNumCells(); k++)
+            {
+                int corner;
+                if (shape.cornerFor(cell, k, corner) && m_starts[length][v].test(corner))
+                {
+                    m_starts[length][v].reset(corner);
+                    drop(corner, shape);
+                }
+            }
+        }
+    }
+    relinkTouched();
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::sink(int length)
+{
+    if (!m_floating[length]) return;
+    m_floating[length] = false;
+
+    for (int v = 0; v < m_numShapes[length]; v++)
+    {
+        Mask &corners = m_starts[length][v];
+        for (int corner = corners.first(); corner >= 0; corner = corners.first())
+        {
+            corners.reset(corner);
+            drop(corner, *m_shapes[length][v]);
+        }
+    }
+    relinkTouched();
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::remove(int cell)
+{
+    if (m_fired.test(cell)) return;
+    unlink(cell);
+    m_fired.set(cell);
+}
+
+template <class BoardType>
+int Heatmap<BoardType>::best()
+{
+    while (m_max > 0 && m_head[m_max] < 0) m_max--;
+    return m_head[m_max];
+}
+
+template <class BoardType>
+void Heatmap<BoardType>::sync(const Mask &hits, const Mask &misses, const Mask &sunkCells, const bool floating[], int numShips)
+{
+    Mask marked = hits | misses;
+    if (!m_ready || numShips != m_numShips || m_fired.andNot(marked).any())
+    {
+        bool all[MAX_SHIP_NUM + 1];
+        for (int length = 0; length <= MAX_SHIP_NUM; length++) all[length] = true;
+        reset(all, numShips);
+    }
+
+    for (int length = 1; length <= numShips; length++)
+    {
+        if (m_floating[length] && !floating[length]) sink(length);
+    }
+
+    Mask newlyBlocked = (misses | sunkCells).andNot(m_blocked);
+    for (int cell = newlyBlocked.first(); cell >= 0; cell = newlyBlocked.first())
+    {
+        newlyBlocked.reset(cell);
+        block(cell);
+    }
+
+    Mask newlyFired = marked.andNot(m_fired);
+    for (int cell = newlyFired.first(); cell >= 0; cell = newlyFired.first())
+    {
+        newlyFired.reset(cell);
+        remove(cell);
+    }
+}
+
+template class Heatmap<NormalBoard>;
+template class Heatmap<XLBoard>;
@@ -0,0 +1,150 @@
+/*------------------------------------------------------------
+ * @Filename: heatmap.h
+ * @Description: per-cell placement counts kept up to date shot by shot
+ ------------------------------------------------------------*/
+
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include "board.h"
+#include "placement.h"
+
+/**
+ * @brief How many placements of the floating enemy ships cover each cell, updated incrementally
+ *
+ * A heatmap follows one attacker's enemy_ships board. A placement is a ship
+ * length, one of its shapes (ShipShape::variants) and a corner cell; it stays counted until one of its
+ * cells is blocked (a miss, or a cell of a sunk ship) or its ship sinks, and
+ * only then are its cells decremented. A miss therefore costs the placements
+ * through that one cell instead of a recount of the whole board.
+ *
+ * The cells not yet fired at are kept in a bucket queue: one doubly linked list
+ * per count. Counts only ever go down, so the highest non-empty bucket is found
+ * by moving a single pointer down.
+ */
+template <class BoardType>
+class Heatmap
+{
+    public:
+        typedef typename BoardType::Mask Mask;
+
+        static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+        static const int MAX_VARIANTS = ShipShape<BoardType>::MAX_VARIANTS;
+        // A ship of length L covers a cell with at most L placements each way, and a bent ship with at most L per orientation
+        static const int MAX_COUNT = MAX_SHIP_NUM * (MAX_SHIP_NUM + 1) + Orientations::COUNT * (7 + 5);
+
+        /**
+         * @brief Construct an empty heatmap; sync() fills it on first use
+         *
+         */
+        Heatmap();
+
+        /**
+         * @brief Count every placement of the floating ships on an empty board
+         *
+         * A whole fleet afloat is copied from a heatmap counted once per fleet size.
+         *
+         * @param floating floating[L] is true if the ship of length L is still afloat
+         * @param numShips The number of ships in the fleet
+         */
+        void reset(const bool floating[], int numShips);
+
+        /**
+         * @brief Bring the heatmap up to date with the attacker's marks on the enemy board
+         *
+         * Only the cells marked since the last call are processed. If there are
+         * fewer marks than last time (a new game) the heatmap starts over.
+         *
+         * @param hits The attacker's hits
+         * @param misses The attacker's misses
+         * @param sunkCells Every cell of every sunk enemy ship
+         * @param floating floating[L] is true if the ship of length L is still afloat
+         * @param numShips The number of ships in the fleet
+         */
+        void sync(const Mask &hits, const Mask &misses, const Mask &sunkCells, const bool floating[], int numShips);
+
+        /**
+         * @brief Drop every placement through a cell
+         *
+         * @param cell The miss or sunk ship cell
+         */
+        void block(int cell);
+
+        /**
+         * @brief Drop every placement of a ship which has sunk
+         *
+         * @param length The ship's length
+         */
+        void sink(int length);
+
+        /**
+         * @brief Stop offering a cell as a target once it has been fired at
+         *
+         * @param cell The cell
+         */
+        void remove(int cell);
+
+        /**
+         * @brief Get the untried cell covered by the most placements
+         *
+         * @return int The cell, or -1 if every cell has been fired at
+         */
+        int best();
+
+        /**
+         * @brief Get the number of placements covering a cell
+         *
+         * @param cell The cell
+         * @return int The count
+         */
+        int getCount(int cell) const { return m_count[cell]; }
+
+    private:
+        /**
+         * @brief Get the heatmap of a whole fleet on an empty board
+         *
+         */
+        static const Heatmap &fresh(int numShips);
+
+        /**
+         * @brief Count the placements from scratch; the work behind reset()
+         *
+         */
+        void count(const bool floating[], int numShips);
+
+        /**
+         * @brief Take one placement off the count of each of its cells
+         *
+         * Cells are unlinked from their bucket the first time they are touched
+         * and only relinked by relinkTouched(), so a block or sink moves each
+         * cell between buckets once however many placements it loses.
+         */
+        void drop(int corner, const ShipShape<BoardType> &shape);
+
+        void relinkTouched();
+
+        void link(int cell);
+        void unlink(int cell);
+
+        Mask m_starts[MAX_SHIP_NUM + 1][MAX_VARIANTS];      // corners of the counted placements by length and shape
+        const ShipShape<BoardType> *m_shapes[MAX_SHIP_NUM + 1][MAX_VARIANTS];
+        int m_numShapes[MAX_SHIP_NUM + 1];
+        bool m_floating[MAX_SHIP_NUM + 1];
+        int m_numShips;
+
+        Mask m_blocked;
+        Mask m_fired;
+        Mask m_touched;
+        bool m_ready;
+
+        short m_count[BoardType::CELLS];
+        short m_next[BoardType::CELLS];
+        short m_prev[BoardType::CELLS];
+        short m_head[MAX_COUNT + 1];
+        int m_max;
+};
+
+extern template class Heatmap<NormalBoard>;
+extern template class Heatmap<XLBoard>;
+
+#endif
@@ -1,9 +1,58 @@
 
 #include "machine.h"
+#include <atomic>
 #include <ctime>
 
+namespace
+{
+    // Give every default-constructed Machine its own stream
+    std::atomic<uint64_t> nextStream(0);
+}
+
 Machine::Machine(){
-	srand (time(NULL));  
+	gamemode = 'N';
+	difficultyLevel = 'E';
+	seed(static_cast<uint64_t>(time(NULL)), nextStream++);
+}
+
+Machine::Machine(uint64_t seedValue, uint64_t stream){
+	gamemode = 'N';
+	difficultyLevel = 'E';
+	seed(seedValue, stream);
+}
+
+void Machine::seed(uint64_t seedValue, uint64_t stream){
+	// PCG32 initialisation: the stream selects the increment, which must be odd
+	state = 0;
+	increment = (stream << 1) | 1;
+	next();
+	state += seedValue;
+	next();
+}
+
+uint32_t Machine::next(){
+	uint64_t old = state;
+	state = old * 6364136223846793005ULL + increment;
+	uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+	uint32_t rot = static_cast<uint32_t>(old >> 59);
+	return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+int Machine::randomBelow(int bound){
+	// Lemire's multiply-shift: the high half of next() * bound is in [0, bound).
+	// Only the few low halves below 2^32 % bound are biased; the modulo to find
+	// that threshold is only taken when the low half is small enough to matter.
+	uint32_t range = static_cast<uint32_t>(bound);
+	uint64_t product = static_cast<uint64_t>(next()) * range;
+	uint32_t low = static_cast<uint32_t>(product);
+	if (low < range) {
+		uint32_t threshold = (0u - range) % range;
+		while (low < threshold) {
+			product = static_cast<uint64_t>(next()) * range;
+			low = static_cast<uint32_t>(product);
+		}
+	}
+	return static_cast<int>(product >> 32);
 }
 
 void Machine::setGameMode(char foo){
@@ -25,39 +74,18 @@ char Machine::getDifficultyLevel(){
 int Machine::charToInt(char c) {return ((toupper(c) - 65));}
 
 int Machine::randomNum(){
-	//add more conditions if they choose the xl board
-    //srand (time(NULL)); 
-	int randInt;
 	if(gamemode == 'X'){
-		randInt = (rand() % 20);
+		return randomBelow(20);
 	}
-	else{
-		randInt = (rand() % 9);
-	}
-    return(randInt);
+	return randomBelow(9);
 }
 
 int Machine::randomChar(){
-	char c;
-    int r;
-    int charInt;
-
-	if(gamemode == 'X'){
-		r = rand() % 20;   
-    	c = 'a' + r;
-    	charInt = charToInt(c);
-	}
-	else{
-		r = rand() % 9;   
-    	c = 'a' + r;
-    	charInt = charToInt(c);
-	}
-	return(charInt);
+	// Columns are drawn the same way as rows; the result is already the column index
+	return randomNum();
 }
 
 char Machine::getRandomDirection(){
 	char directionArray[4] = {'U','D','R','L'};
-	int position = rand() % 4;
-	char randDirection = directionArray[position];
-	return(randDirection);
-}
\ No newline at end of file
+	return directionArray[randomBelow(4)];
+}
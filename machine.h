@@ -3,6 +3,7 @@
 
 #include<ctime>
 #include<iostream>
+#include<stdint.h>
 using namespace std;
 
 class Machine
@@ -11,11 +12,42 @@ class Machine
     public:
 
         /**
-         * @brief Construct a new Machine to handle AI gameplay
+         * @brief Construct a new Machine to handle AI gameplay, seeded from the clock
          * 
          */
         Machine();
 
+        /**
+         * @brief Construct a new Machine with a reproducible random sequence
+         * 
+         * @param seedValue The seed
+         * @param stream The stream id. Machines with the same seed and different streams are independent.
+         */
+        Machine(uint64_t seedValue, uint64_t stream);
+
+        /**
+         * @brief Restart the random sequence
+         * 
+         * @param seedValue The seed
+         * @param stream The stream id
+         */
+        void seed(uint64_t seedValue, uint64_t stream);
+
+        /**
+         * @brief Generate the next raw 32-bit random number
+         * 
+         * @return uint32_t The generated number
+         */
+        uint32_t next();
+
+        /**
+         * @brief Generate an unbiased random number in [0, bound)
+         * 
+         * @param bound The exclusive upper bound, greater than 0
+         * @return int The generated number
+         */
+        int randomBelow(int bound);
+
         /**
          * @brief Convert a character to the int it represents
          * 
@@ -60,21 +92,25 @@ class Machine
         char getGameMode();
 
         /**
-         * @brief Set the Difficulty Level (either 'E', 'M', or 'H')
+         * @brief Set the Difficulty Level (either 'E', 'M', 'H', or 'X' for expert)
          * 
-         * @param foo The difficulty level to set the game to (either 'E', 'M', or 'H')
+         * @param foo The difficulty level to set the game to (either 'E', 'M', 'H', or 'X')
          */
         void setDifficultyLevel(char foo);
         /**
-         * @brief Get the Difficulty Level (either 'E', 'M', or 'H')
+         * @brief Get the Difficulty Level (either 'E', 'M', 'H', or 'X' for expert)
          * 
-         * @return char The difficulty level the game is set to (either 'E', 'M', or 'H')
+         * @return char The difficulty level the game is set to (either 'E', 'M', 'H', or 'X')
          */
         char getDifficultyLevel();
 
     private:
         char gamemode;
         char difficultyLevel;
+
+        // PCG32 generator state, owned by this Machine only
+        uint64_t state;
+        uint64_t increment;
     
 };
 #endif
\ No newline at end of file
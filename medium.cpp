@@ -1,17 +1,24 @@
 //MEDIUM CPP
 
 #include "medium.h"
+#include "stats.h"
 
-Medium::Medium() {
+template <class BoardType>
+Medium<BoardType>::Medium() {
     row = 0;
     col = 0;
+    machine.setGameMode(BoardType::checkBig() ? 'X' : 'N');
 }
 
-bool Medium::notInArray(int row, int col){
+template <class BoardType>
+void Medium<BoardType>::seed(uint64_t seedValue, uint64_t stream) { machine.seed(seedValue, stream); }
+
+template <class BoardType>
+bool Medium<BoardType>::notInArray(int row, int col){
     if((row == hitRow) && (col == hitCol)){
         return false;
     }
-    for(int i = 0; i< value; i++){
+    for(int i = 0; i< hits; i++){
         if((hitGuess[i][0] == row) && (hitGuess[i][1] == col)){
             return false;
         }
@@ -21,164 +28,107 @@ bool Medium::notInArray(int row, int col){
 
 
 
-void Medium::guessSpot(int row, int col){
-    if (otherPlayer->CheckHit(row, col)){
-        currentPlayer->enemy_ships.updateBoard(row, col, 'X');
-        otherPlayer->my_ships.updateBoard(row,col, 'X');
-        if (otherPlayer->my_ships.allShipsSunk()){
-            cout << "The Machine wins!\n";
-        }
-        else{
-            if(otherPlayer->my_ships.shipIsSunk(row,col)){
-                hits = 0;
-                haveGuesses = false;
-                tracking = 0;
-                attackShip = false;
-            }
+template <class BoardType>
+void Medium<BoardType>::observe(int cell, const Shot &shot){
+    if(!attackShip){
+        // A hunting shot: follow up a hit unless it sank the ship outright
+        if(shot.result == SHOT_HIT){
+            attackShip = true;
+            hitRow = cell / BoardType::COLS;
+            hitCol = cell % BoardType::COLS;
+            shipKey = shot.ship;
         }
     }
-    else{
-        cout<<"You messed up again\n";
+    else if(shot.result == SHOT_SUNK || shot.result == SHOT_WIN){
+        hits = 0;
+        haveGuesses = false;
+        tracking = 0;
+        attackShip = false;
     }
-
 }
 
-bool Medium::move(int row, int col){
-
-    if(hits == value){
-        return true;
-    }
-
-    if(checkCoords(row-1,col)){
-
-        if((otherPlayer->my_ships.getValue(row-1, col) == 'S') && (otherPlayer->my_ships.getShipNum(row-1,col) == shipKey))
-        {
-            if(notInArray(row-1,col)){
-                hitGuess[hits][0] = row -1;
-                hitGuess[hits][1] = col;
-                hits++;
-                if(move(row-1,col)){
-                    return true;
-                }
-            }
+template <class BoardType>
+bool Medium<BoardType>::expand(int row, int col){
+    static const int dRow[4] = {-1, 0, 1, 0};
+    static const int dCol[4] = {0, 1, 0, -1};
+
+    // Each frame is a tile and the next direction to look in from it
+    int stackRow[MAX_TARGETS + 1];
+    int stackCol[MAX_TARGETS + 1];
+    int stackDir[MAX_TARGETS + 1];
+    int depth = 0;
+    stackRow[0] = row;
+    stackCol[0] = col;
+    stackDir[0] = 0;
+
+    while(depth >= 0 && hits < value){
+        if(stackDir[depth] == 4){
+            depth--;
+            continue;
         }
-    }
-    if(checkCoords(row,col+1)){
-        if((otherPlayer->my_ships.getValue(row, col+1) == 'S') && (otherPlayer->my_ships.getShipNum(row,col+1) == shipKey)){
-            if(notInArray(row,col+1)){
-                hitGuess[hits][0] = row;
-                hitGuess[hits][1] = col+1;
-                hits++;
-                if(move(row,col+1)){
-                    return true;
-                }
-            }
+        int dir = stackDir[depth]++;
+        int nextRow = stackRow[depth] + dRow[dir];
+        int nextCol = stackCol[depth] + dCol[dir];
+        STATS_COUNT(MEDIUM_CELLS_SCANNED);
+
+        if(checkCoords(nextRow, nextCol) &&
+           (otherPlayer->my_ships.getValue(nextRow, nextCol) == 'S') &&
+           (otherPlayer->my_ships.getShipNum(nextRow, nextCol) == shipKey) &&
+           notInArray(nextRow, nextCol)){
+            hitGuess[hits][0] = nextRow;
+            hitGuess[hits][1] = nextCol;
+            hits++;
+            depth++;
+            stackRow[depth] = nextRow;
+            stackCol[depth] = nextCol;
+            stackDir[depth] = 0;
         }
     }
-    if(checkCoords(row+1,col)){
-        if((otherPlayer->my_ships.getValue(row+1, col) == 'S') && (otherPlayer->my_ships.getShipNum(row+1,col) == shipKey)){
-            if(notInArray(row+1,col)){
-                hitGuess[hits][0] = row + 1;
-                hitGuess[hits][1] = col;
-                hits++;
-                if(move(row+1,col)){
-                    return(true);
-                }
-            }
-        }
-    }
-    if(checkCoords(row,col-1)){
-        if((otherPlayer->my_ships.getValue(row, col-1) == 'S') && (otherPlayer->my_ships.getShipNum(row,col-1) == shipKey)){
-            if(notInArray(row,col-1)){
-                hitGuess[hits][0] = row;
-                hitGuess[hits][1] = col - 1;
-                hits++;
-                if(move(row,col-1)){
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
+    return hits > 0;
 }
 
 
-void Medium::solve(Player &currentPlayer1, Player &otherPlayer1){
-    currentPlayer = &otherPlayer1;
-    otherPlayer = &currentPlayer1;
+template <class BoardType>
+int Medium<BoardType>::chooseShot(Player<BoardType> &attacker, Player<BoardType> &defender){
+    currentPlayer = &attacker;
+    otherPlayer = &defender;
     if(!attackShip){
-        row = machine.randomNum();
-        col = machine.randomChar();
+        STATS_COUNT(RANDOM_SHOTS);
+        int cell = currentPlayer->untried_cells.sample(machine);
+        row = cell / BoardType::COLS;
+        col = cell % BoardType::COLS;
+        return cell;
+    }
 
-        while(currentPlayer->enemy_ships.getValue(row, col) == 'X' || currentPlayer->enemy_ships.getValue(row, col) == 'O'){
-            row = machine.randomNum();
-            col = machine.randomChar();
-        }
+    if(!haveGuesses){
+        haveGuesses = true;
+        value = shipKey - 1;
 
-        if (otherPlayer->CheckHit(row, col)){
-            currentPlayer->enemy_ships.updateBoard(row, col, 'X');
-            otherPlayer->my_ships.updateBoard(row,col, 'X');
-            if (otherPlayer->my_ships.allShipsSunk()){
-                cout << "The Machine wins!\n";
-            }
-            else{
-                if(!(otherPlayer->my_ships.shipIsSunk(row,col))){
-
-                    attackShip = true;
-                    hitRow = row;
-                    hitCol = col;
-                }
-                else{
-                    cout<<"we just sunk a ship\n";
-                    attackShip = false;
-                }
-            }
+        if(!expand(row,col)){
+            return -1;
         }
-        else{
-            currentPlayer->enemy_ships.updateBoard(row, col, 'O');
-            otherPlayer->my_ships.updateBoard(row,col,'O');
-        }
-
     }
-    else{
-        if(!haveGuesses){
-            haveGuesses = true;
-            value = otherPlayer->my_ships.getShipNum(hitRow,hitCol) - 1;
-            shipKey = otherPlayer->my_ships.getShipNum(hitRow,hitCol);
-            if(value == 0){
-                cout<<"issue\n";
-            }
-            hitGuess = new int*[value];
-            for(int i = 0; i < value; i++){
-                hitGuess[i] = new int[2];
-            }
-
-            if(move(row,col)){
-                row = hitGuess[tracking][0];
-                col = hitGuess[tracking][1];
-                tracking++;
-                guessSpot(row,col);
-
-            }
-            else{
-                cout<<"your move is returning FALSE\n";
-            }
-        }
-        else{
-            row = hitGuess[tracking][0];
-            col = hitGuess[tracking][1];
-            tracking++;
-            guessSpot(row,col);
-        }
-
+    else if(tracking >= hits){
+        // Ran out of guesses without sinking the ship; go back to hunting
+        hits = 0;
+        haveGuesses = false;
+        tracking = 0;
+        attackShip = false;
+        return -1;
     }
+
+    row = hitGuess[tracking][0];
+    col = hitGuess[tracking][1];
+    tracking++;
+    return row * BoardType::COLS + col;
 }
 
-bool Medium::checkCoords(int row, int col){
-    if((row < 0) || (row > 8)){
+template <class BoardType>
+bool Medium<BoardType>::checkCoords(int row, int col){
+    if((row < 0) || (row >= BoardType::getNumRows())){
         return false;
     }
-    else if((col < 0) || (col > 8)){
+    else if((col < 0) || (col >= BoardType::getNumCols())){
         return false;
     }
     else if((currentPlayer->enemy_ships.getValue(row, col) == 'X' || currentPlayer->enemy_ships.getValue(row, col) == 'O')){
@@ -186,3 +136,6 @@ bool Medium::checkCoords(int row, int col){
     }
     return true;
 }
+
+template class Medium<NormalBoard>;
+template class Medium<XLBoard>;
@@ -10,23 +10,45 @@
 #include<iostream>
 using namespace std;
 
+/**
+ * @brief The medium difficulty AI, templated on the board type it plays on
+ *
+ */
+template <class BoardType>
 class Medium{
 
     public:
         /**
-         * @brief Choose where to fire a shot
+         * @brief Choose where to fire next. Does not fire.
          * 
-         * @param currentPlayer The player's board
-         * @param otherPlayer The AI's board
+         * @param attacker The AI's player
+         * @param defender The player being fired at
+         * @return int The cell to fire at (row * numCols + col), or -1 if no shot could be found this turn
          */
-        void solve(Player &currentPlayer, Player &otherPlayer); // calls recursive function but does not recurse itself
+        int chooseShot(Player<BoardType> &attacker, Player<BoardType> &defender);
+        /**
+         * @brief Learn the outcome of the shot chooseShot picked
+         * 
+         * @param cell The cell fired at
+         * @param shot What the shot did, as Player::Fire reported it
+         */
+        void observe(int cell, const Shot &shot);
         /**
          * @brief Construct a new Medium AI
          * 
          */
         Medium();
 
+        /**
+         * @brief Restart the AI's random sequence so its shots can be replayed
+         * 
+         * @param seedValue The seed
+         * @param stream The stream id
+         */
+        void seed(uint64_t seedValue, uint64_t stream);
+
     private:
+        static const int MAX_TARGETS = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;  // the longest ship, less the tile already hit
 
         /**
          * @brief Check if the given coordinate is valid placement
@@ -38,21 +60,17 @@ class Medium{
          */
         bool checkCoords(int row, int col);
         /**
-         * @brief Check if the player's ship is at the given spot
+         * @brief Queue the untried tiles of the ship at the given spot, walking out from it one neighbor at a time
          * 
-         * @param row The row to check
-         * @param col The column to check 
-         */
-        void guessSpot(int row, int col);
-        /**
-         * @brief Check around the given spot for another spot to shoot at
+         * The walk is depth first (up, right, down, left) with an explicit
+         * stack, and stops once value tiles are queued.
          * 
-         * @param row The row to check near
-         * @param col The column to check near
-         * @return true A spot was found
-         * @return false A spot could not be found
+         * @param row The row of the hit to start from
+         * @param col The column of the hit to start from
+         * @return true At least one spot was queued
+         * @return false No spot could be found
          */
-        bool move(int row, int col);
+        bool expand(int row, int col);
         /**
          * @brief Check if a given coordinate is in the current array
          * 
@@ -69,11 +87,11 @@ class Medium{
         int hitCol;
         bool attackShip = false;
         Machine machine;
-        Player* currentPlayer;
-        Player* otherPlayer;
+        Player<BoardType>* currentPlayer;
+        Player<BoardType>* otherPlayer;
 
-        int hits = 0;
-        int** hitGuess;
+        int hits = 0;              // the number of queued tiles
+        int hitGuess[MAX_TARGETS][2];
         bool haveGuesses = false;
         int tracking = 0;
         int shipKey;
@@ -82,4 +100,7 @@ class Medium{
 
 
 };
+
+extern template class Medium<NormalBoard>;
+extern template class Medium<XLBoard>;
 #endif
@@ -0,0 +1,210 @@
+#include "placement.h"
+
+namespace
+{
+    // The orientation of a line which runs from the pivot in each direction; see ShapeTable
+    const char LINE_DIRECTIONS[] = "DLUR";
+}
+
+template <class BoardType>
+ShipShape<BoardType>::ShipShape()
+{
+    m_numCells = 0;
+    m_top = 0;
+    m_left = 0;
+    m_height = 0;
+    m_width = 0;
+    m_direction = 0;
+    m_orientation = 0;
+}
+
+template <class BoardType>
+void ShipShape<BoardType>::build(const Polyomino &shape, char direction, int orientation)
+{
+    int minRow = 0, minCol = 0, maxRow = 0, maxCol = 0;
+    for (int i = 0; i < shape.numCells; i++)
+    {
+        if (shape.cells[i].row < minRow) minRow = shape.cells[i].row;
+        if (shape.cells[i].row > maxRow) maxRow = shape.cells[i].row;
+        if (shape.cells[i].col < minCol) minCol = shape.cells[i].col;
+        if (shape.cells[i].col > maxCol) maxCol = shape.cells[i].col;
+    }
+    m_top = -minRow;
+    m_left = -minCol;
+    m_height = maxRow - minRow + 1;
+    m_width = maxCol - minCol + 1;
+    m_direction = direction;
+    m_orientation = orientation;
+
+    m_numCells = shape.numCells;
+    m_cells.clear();
+    for (int i = 0; i < shape.numCells; i++)
+    {
+        m_rows[i] = shape.cells[i].row + m_top;
+        m_cols[i] = shape.cells[i].col + m_left;
+        m_offsets[i] = m_rows[i] * BoardType::COLS + m_cols[i];
+        m_cells.set(m_offsets[i]);
+    }
+
+    m_corners.clear();
+    for (int row = 0; row + m_height <= BoardType::ROWS; row++)
+    {
+        for (int col = 0; col + m_width <= BoardType::COLS; col++)
+        {
+            m_corners.set(row * BoardType::COLS + col);
+        }
+    }
+}
+
+/**
+ * @brief Every ShipShape of one board type, built from SHAPE_TABLE on first use
+ *
+ */
+template <class BoardType>
+struct ShapeMasks
+{
+    static const int MAX_SHIP_NUM = ShipShape<BoardType>::MAX_SHIP_NUM;
+    static const int SLOTS = 4 + Orientations::COUNT;   // the four line directions, then the bent orientations
+
+    ShipShape<BoardType> shapes[MAX_SHIP_NUM + 1][SLOTS];
+    bool valid[MAX_SHIP_NUM + 1][SLOTS];
+    const ShipShape<BoardType> *variants[MAX_SHIP_NUM + 1][ShipShape<BoardType>::MAX_VARIANTS];
+    int numVariants[MAX_SHIP_NUM + 1];
+};
+
+template <class BoardType>
+const ShipShape<BoardType> *ShipShape<BoardType>::find(int size, char direction, int orientation)
+{
+    const ShapeMasks<BoardType> &table = masks();
+    if (size < 1 || size > MAX_SHIP_NUM) return NULL;
+
+    int slot = 0;
+    if (direction == 'V' || direction == 'N')
+    {
+        if (orientation < 0 || orientation >= Orientations::COUNT) return NULL;
+        if (direction != (size == 7 ? 'V' : 'N')) return NULL;
+        slot = 4 + orientation;
+    }
+    else
+    {
+        while (slot < 4 && LINE_DIRECTIONS[slot] != direction) slot++;
+        if (slot == 4) return NULL;
+    }
+    return table.valid[size][slot] ? &table.shapes[size][slot] : NULL;
+}
+
+template <class BoardType>
+int ShipShape<BoardType>::variants(int size, const ShipShape *shapes[])
+{
+    const ShapeMasks<BoardType> &table = masks();
+    if (size < 1 || size > MAX_SHIP_NUM) return 0;
+    for (int i = 0; i < table.numVariants[size]; i++) shapes[i] = table.variants[size][i];
+    return table.numVariants[size];
+}
+
+template <class BoardType>
+const ShapeMasks<BoardType> &ShipShape<BoardType>::masks()
+{
+    // Built once per board type; C++11 makes the first call thread-safe
+    struct Builder : ShapeMasks<BoardType>
+    {
+        Builder()
+        {
+            for (int size = 0; size <= MAX_SHIP_NUM; size++)
+            {
+                this->numVariants[size] = 0;
+                for (int slot = 0; slot < this->SLOTS; slot++) this->valid[size][slot] = false;
+                if (size == 0) continue;
+
+                for (int slot = 0; slot < 4; slot++)
+                {
+                    if (size > BoardType::ROWS && size > BoardType::COLS) break;
+                    this->shapes[size][slot].build(SHAPE_TABLE.lines[size].shapes[slot], LINE_DIRECTIONS[slot], 0);
+                    this->valid[size][slot] = true;
+                }
+                const Orientations *bent = size == 7 ? &SHAPE_TABLE.v : size == 5 ? &SHAPE_TABLE.n : NULL;
+                for (int o = 0; bent && o < Orientations::COUNT; o++)
+                {
+                    this->shapes[size][4 + o].build(bent->shapes[o], size == 7 ? 'V' : 'N', o);
+                    this->valid[size][4 + o] = true;
+                }
+
+                // Straight ships once each way (a single cell once), then each distinct bent shape
+                const int lineSlots[2] = {size == 1 ? 2 : 0, 3};   // 'U' for a single cell, else 'D' and 'R'
+                for (int i = 0; i < (size == 1 ? 1 : 2); i++)
+                {
+                    if (this->valid[size][lineSlots[i]]) add(size, lineSlots[i]);
+                }
+                for (int slot = 4; slot < this->SLOTS; slot++)
+                {
+                    if (this->valid[size][slot]) add(size, slot);
+                }
+            }
+        }
+
+        void add(int size, int slot)
+        {
+            const ShipShape &shape = this->shapes[size][slot];
+            for (int i = 0; i < this->numVariants[size]; i++)
+            {
+                const ShipShape &other = *this->variants[size][i];
+                if (other.m_height == shape.m_height && other.m_width == shape.m_width && !(other.m_cells ^ shape.m_cells).any()) return;
+            }
+            this->variants[size][this->numVariants[size]++] = &shape;
+        }
+    };
+    static const Builder table;
+    return table;
+}
+
+template <class BoardType>
+bool ShipShape<BoardType>::at(int row, int col, Mask &cells) const
+{
+    int top = row - m_top;
+    int left = col - m_left;
+    if (top < 0 || left < 0 || top + m_height > BoardType::ROWS || left + m_width > BoardType::COLS) return false;
+    cells = m_cells << (top * BoardType::COLS + left);
+    return true;
+}
+
+template <class BoardType>
+typename ShipShape<BoardType>::Mask ShipShape<BoardType>::legalCorners(const Mask &free) const
+{
+    // A corner is legal if every cell of the shape placed there is free
+    Mask corners = m_corners;
+    for (int i = 0; i < m_numCells && corners.any(); i++)
+    {
+        corners &= free >> m_offsets[i];
+    }
+    return corners;
+}
+
+template <class BoardType>
+typename ShipShape<BoardType>::Mask ShipShape<BoardType>::legalPivots(const Mask &free) const
+{
+    return legalCorners(free) << (m_top * BoardType::COLS + m_left);
+}
+
+template <class BoardType>
+typename ShipShape<BoardType>::Mask ShipShape<BoardType>::covering(const Mask &cells) const
+{
+    Mask corners;
+    for (int i = 0; i < m_numCells; i++)
+    {
+        corners |= cells >> m_offsets[i];
+    }
+    return corners & m_corners;
+}
+
+template <class BoardType>
+bool ShipShape<BoardType>::cornerFor(int cell, int k, int &corner) const
+{
+    int top = cell / BoardType::COLS - m_rows[k];
+    int left = cell % BoardType::COLS - m_cols[k];
+    if (top < 0 || left < 0 || top + m_height > BoardType::ROWS || left + m_width > BoardType::COLS) return false;
+    corner = top * BoardType::COLS + left;
+    return true;
+}
+
+template class ShipShape<NormalBoard>;
+template class ShipShape<XLBoard>;
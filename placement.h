@@ -0,0 +1,174 @@
+/*------------------------------------------------------------
+ * @Filename: placement.h
+ * @Description: ship shapes as precomputed masks, placed and enumerated with bit operations
+ ------------------------------------------------------------*/
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include "board.h"
+#include "shapes.h"
+
+template <class BoardType> struct ShapeMasks;
+
+/**
+ * @brief One ship shape in one orientation, as a mask ready to shift onto a board
+ *
+ * The cells come from the compile-time SHAPE_TABLE and are given relative to
+ * the pivot the player picks. m_cells holds them with the top-left corner of
+ * their bounding box (the shape's corner) at cell 0, so placing the shape is one
+ * shift to the corner, and checking it is one AND against the cells already
+ * taken. Straight and bent shapes cost the same.
+ *
+ * Every shape is built once per board type; find() and variants() hand out the
+ * shared copies.
+ */
+template <class BoardType>
+class ShipShape
+{
+    public:
+        typedef typename BoardType::Mask Mask;
+
+        static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+        static const int MAX_CELLS = Polyomino::MAX_CELLS;
+        static const int MAX_VARIANTS = 2 + Orientations::COUNT;   // a line across and down, and every orientation of a bent shape
+
+        /**
+         * @brief Look up the shape of a ship
+         *
+         * @param size The size of the ship
+         * @param direction 'U', 'D', 'L' or 'R' for a straight ship running that way from the pivot,
+         *                  'V' for the size 7 ship or 'N' for the size 5 ship
+         * @param orientation For 'V' and 'N', which of the Orientations (0 to 7); ignored for straight ships
+         * @return const ShipShape* The shape, or NULL if that ship cannot take that direction
+         */
+        static const ShipShape *find(int size, char direction, int orientation = 0);
+
+        /**
+         * @brief List every differently shaped placement a ship can take
+         *
+         * A straight ship has two (across and down, one if it is a single
+         * cell); the size 5 and size 7 ships add their bent shapes, each
+         * orientation which covers different cells listed once.
+         *
+         * @param size The size of the ship
+         * @param shapes Filled with the shapes, MAX_VARIANTS long
+         * @return int The number of shapes
+         */
+        static int variants(int size, const ShipShape *shapes[]);
+
+        /**
+         * @brief Get the cells the ship covers with its pivot at a cell
+         *
+         * @param row The row of the pivot
+         * @param col The column of the pivot
+         * @param cells Set to the covered cells
+         * @return true The ship fits on the board
+         * @return false Part of the ship would be off the board; cells is unchanged
+         */
+        bool at(int row, int col, Mask &cells) const;
+
+        /**
+         * @brief Find every pivot at which the ship fits on the board and covers only free cells
+         *
+         * @param free The cells the ship may cover
+         * @return Mask The legal pivot cells
+         */
+        Mask legalPivots(const Mask &free) const;
+
+        /**
+         * @brief Find every corner at which the ship fits on the board and covers only free cells
+         *
+         * @param free The cells the ship may cover
+         * @return Mask The legal corners
+         */
+        Mask legalCorners(const Mask &free) const;
+
+        /**
+         * @brief Find the corners of the placements which cover at least one of some cells
+         *
+         * @param cells The cells
+         * @return Mask The corners, on the board or not
+         */
+        Mask covering(const Mask &cells) const;
+
+        /**
+         * @brief Get the cells of the shape placed with its corner at a cell
+         *
+         * @param corner A corner at which the shape fits on the board
+         * @return Mask The covered cells
+         */
+        Mask cellsAt(int corner) const { return m_cells << corner; }
+
+        /**
+         * @brief Find the corner which puts one of the shape's cells on a given cell
+         *
+         * @param cell The cell
+         * @param k Which of the shape's cells, 0 to getNumCells() - 1
+         * @param corner Set to the corner
+         * @return true The shape fits on the board there
+         * @return false It does not; corner is unchanged
+         */
+        bool cornerFor(int cell, int k, int &corner) const;
+
+        /**
+         * @brief Get the pivot of the shape placed with its corner at a cell
+         *
+         * @param corner The corner
+         * @return int The pivot cell
+         */
+        int pivotOf(int corner) const { return corner + m_top * BoardType::COLS + m_left; }
+
+        /**
+         * @brief Check whether the shape covers a cell of its bounding box
+         *
+         * @param row The row in the box, from 0 to getHeight() - 1
+         * @param col The column in the box, from 0 to getWidth() - 1
+         * @return true The shape covers that cell
+         */
+        bool covers(int row, int col) const { return m_cells.test(row * BoardType::COLS + col); }
+
+        int getNumCells() const { return m_numCells; }
+        int getOffset(int k) const { return m_offsets[k]; }   // of cell k from the corner
+        int getHeight() const { return m_height; }
+        int getWidth() const { return m_width; }
+        int getPivotRow() const { return m_top; }    // the pivot's place in the bounding box
+        int getPivotCol() const { return m_left; }
+        char getDirection() const { return m_direction; }
+        int getOrientation() const { return m_orientation; }
+
+    private:
+        friend struct ShapeMasks<BoardType>;
+
+        ShipShape();
+
+        /**
+         * @brief Get the table of every shape, built on first use
+         *
+         */
+        static const ShapeMasks<BoardType> &masks();
+
+        /**
+         * @brief Build the masks of one polyomino for this board
+         *
+         */
+        void build(const Polyomino &shape, char direction, int orientation);
+
+        Mask m_cells;       // the shape with its corner at cell 0
+        Mask m_corners;     // the corners at which the bounding box stays on the board
+        int m_offsets[MAX_CELLS];
+        int m_rows[MAX_CELLS];      // the row and column of each cell in the bounding box
+        int m_cols[MAX_CELLS];
+        int m_numCells;
+        int m_top;          // the pivot's row minus the bounding box's top row
+        int m_left;         // the pivot's column minus the bounding box's left column
+        int m_height;
+        int m_width;
+        char m_direction;
+        int m_orientation;
+};
+
+extern template class ShipShape<NormalBoard>;
+extern template class ShipShape<XLBoard>;
+
+#endif
@@ -1,228 +1,157 @@
 //Player.cpp
 
 #include "player.h"
+#include "stats.h"
 #include <iostream>
 
-Player::Player(bool big) {
-    if (big) {
-        my_ships.setBig();
-        enemy_ships.setBig();
-    }
-}
+template <class BoardType>
+Player<BoardType>::Player() {}
 
-Player::~Player() {}
+template <class BoardType>
+Player<BoardType>::~Player() {}
 
-void Player::SetNumShips(int ships) {numShips = ships; }
+template <class BoardType>
+void Player<BoardType>::SetNumShips(int ships) {numShips = ships; }
 
-void Player::PrintMyShips() { my_ships.printBoard(); }
+template <class BoardType>
+void Player<BoardType>::PrintMyShips() { my_ships.printBoard(); }
 
-void Player::PrintEnemyShips() { enemy_ships.printBoard(); }
+template <class BoardType>
+void Player<BoardType>::PrintEnemyShips() { enemy_ships.printBoard(); }
 
-void Player::UpdateEnemyBoard(int row, int col, bool hit)
+template <class BoardType>
+void Player<BoardType>::UpdateEnemyBoard(int row, int col, bool hit)
 {
     if (hit) enemy_ships.updateBoard(row, col, 'X');
     else enemy_ships.updateBoard(row, col, 'O');
+    untried_cells.remove(row * BoardType::COLS + col);
 }
 
-bool Player::PlaceShip(int size, int row, int col, char direction)
+template <class BoardType>
+bool Player<BoardType>::PlaceShip(int size, int row, int col, char direction, int orientation)
 {
-    if (direction == 'R') // try to place ship right of pivot coordinates row, col
-    {
-        if (my_ships.getNumCols() - col >= size) // make sure there are enough indices to place ship
-        {
-            for (int j = col; j < col + size; j++) // make sure no ships have already been placed in each spot
-            {
-                if (my_ships.getValue(row, j) != '-') return false; // fails to place if something is already there
-            }
-            for (int j = col; j < col + size; j++)
-            {
-                my_ships.updateBoard(row, j, 'S', size); // if not returned by now, place ship
-            }
-        }
-        else return false; // fails to place if not enoguh space
-    }
-    else if (direction == 'L') // Left
-    {
-        if (col - size + 1 >= 0)
-        {
-            for (int j = col; j >= col - size + 1; j--)
-            {
-                if (my_ships.getValue(row, j) != '-') return false;
-            }
-            for (int j = col; j >= col - size + 1; j--)
-            {
-                my_ships.updateBoard(row, j, 'S', size);
-            }
-        }
-        else return false;
-    }
-    else if (direction == 'D') // Down
-    {
-        if (my_ships.getNumRows() - row >= size)
-        {
-            for (int i = row; i < row + size; i++)
-            {
-                if (my_ships.getValue(i, col) != '-') return false;
-            }
-            for (int i = row; i < row + size; i++)
-            {
-                my_ships.updateBoard(i, col, 'S', size);
-            }
-        }
-        else return false;
-    }
-    else if (direction == 'U') // Up
-    {
-        if (row - size + 1 >= 0)
-        {
-            for (int i = row; i >= row - size + 1; i--)
-            {
-                if (my_ships.getValue(i, col) != '-')
-                {
-                    cout << "nope because " << my_ships.getValue(i, col);
-                    return false;
-                }
-            }
-            for (int i = row; i >= row - size + 1; i--)
-            {
-                my_ships.updateBoard(i, col, 'S', size);
-            }
-        }
-        else return false;
-    }
-    
-    else if (direction == 'V') // L-shaped ship
+    STATS_COUNT(PLACE_SHIP_ATTEMPTS);
+    const ShipShape<BoardType> *shape = ShipShape<BoardType>::find(size, direction, orientation);
+    typename BoardType::Mask cells;
+    if (!shape || !shape->at(row, col, cells) || // fails to place if part of the ship is off the board
+        (cells & my_ships.getOccupiedMask()).any()) // or if something is already there
     {
-        if(my_ships.getNumRows()-row >= 4 && my_ships.getNumCols()-col>=4) 
-        {
-            for (int i = row; i < row + 4; i++)
-            {
-                 if (my_ships.getValue(i, col) != '-') return false;
-            }
-            for (int i = row; i < row + 4; i++)
-            {
-                my_ships.updateBoard(i, col, 'S', 7);
-            }
-                        for (int j = col+1; j < col + 4; j++) // make sure no ships have already been placed in each spot
-            {
-                if (my_ships.getValue(row, j) != '-') return false; // fails to place if something is already there
-            }
-            for (int j = col+1; j < col + 4; j++)
-            {
-                 my_ships.updateBoard(row, j, 'S', 7); // if not returned by now, place ship
-            }
-        }
-        else return false;
-    }
-
-    else if (direction == 'N') // L-shaped ship
-    {
-        if(my_ships.getNumRows()-row >= 2 && my_ships.getNumCols()-col>=3) 
-        {
-            for (int i = row; i < row + 2; i++)
-            {
-                 if (my_ships.getValue(i, col) != '-') return false;
-            }
-            for (int i = row; i < row + 2; i++)
-            {
-                my_ships.updateBoard(i, col, 'S', 5);
-            }
-            for (int j = col+1; j < col + 3; j++) // make sure no ships have already been placed in each spot
-            {
-                if (my_ships.getValue(row, j) != '-') return false; // fails to place if something is already there
-            }
-            for (int j = col+1; j < col + 3; j++)
-            {
-                 my_ships.updateBoard(row, j, 'S', 5); // if not returned by now, place ship
-            }
-            if(my_ships.getValue(row+1, col+2) != '-') return false;
-            else my_ships.updateBoard(row+1, col+2, 'S', 5);
-        }
-        else return false;
+        STATS_COUNT(PLACE_SHIP_FAILURES);
+        return false;
     }
-    
+    my_ships.placeShip(cells, size); // every cell at once, so a failed attempt leaves nothing behind
     return true;
+}
 
+template <class BoardType>
+bool Player<BoardType>::PlaceShipAI(int size, int row, int col, char direction, int orientation)
+{
+    STATS_COUNT(PLACE_SHIP_AI_ATTEMPTS);
+    bool placed = PlaceShip(size, row, col, direction, orientation); // every shape in the table, bent ones included
+    if (!placed) STATS_COUNT(PLACE_SHIP_AI_FAILURES);
+    return placed;
 }
 
-bool Player::PlaceShipAI(int size, int row, int col, char direction)
+template <class BoardType>
+typename BoardType::Mask Player<BoardType>::LegalPlacements(int size, char direction, int orientation)
 {
-    if (direction == 'R') // try to place ship right of pivot coordinates row, col
-    {
-        if (my_ships.getNumCols() - col >= size) // make sure there are enough indices to place ship
-        {
-            for (int j = col; j < col + size; j++) // make sure no ships have already been placed in each spot
-            {
-                if (my_ships.getValue(row, j) != '-') return false; // fails to place if something is already there
-            }
-            for (int j = col; j < col + size; j++)
-            {
-                my_ships.updateBoard(row, j, 'S', size); // if not returned by now, place ship
-            }
-        }
-        else return false; // fails to place if not enoguh space
-    }
-    else if (direction == 'L') // Left
+    const ShipShape<BoardType> *shape = ShipShape<BoardType>::find(size, direction, orientation);
+    typedef typename BoardType::Mask Mask;
+    if (!shape) return Mask();
+    return shape->legalPivots(Mask::full().andNot(my_ships.getOccupiedMask()));
+}
+
+template <class BoardType>
+bool Player<BoardType>::CheckHit(int row, int col)
+{
+    if (row > my_ships.getNumRows() - 1 || row < 0 || col > my_ships.getNumCols() - 1 || col < 0 || my_ships.getValue(row, col) == 'X') return false;
+
+    if (my_ships.getValue(row, col) == 'S')
     {
-        if (col - size + 1 >= 0)
-        {
-            for (int j = col; j >= col - size + 1; j--)
-            {
-                if (my_ships.getValue(row, j) != '-') return false;
-            }
-            for (int j = col; j >= col - size + 1; j--)
-            {
-                my_ships.updateBoard(row, j, 'S', size);
-            }
-        }
-        else return false;
+        my_ships.updateBoard(row, col, 'X');
+        return true;
     }
-    else if (direction == 'D') // Down
+    return false;
+}
+
+template <class BoardType>
+Shot Player<BoardType>::Fire(Player &defender, int row, int col)
+{
+    Shot shot = {SHOT_INVALID, 0};
+    if (row < 0 || row >= BoardType::ROWS || col < 0 || col >= BoardType::COLS ||
+        !untried_cells.contains(row * BoardType::COLS + col)) return shot;
+
+    int ship = defender.my_ships.receiveShot(row, col);
+    if (ship < 0) return shot;
+    UpdateEnemyBoard(row, col, ship != 0);
+
+    shot.ship = ship;
+    if (ship == 0) shot.result = SHOT_MISS;
+    else if (!defender.my_ships.shipNumIsSunk(ship)) shot.result = SHOT_HIT;
+    else shot.result = defender.my_ships.allShipsSunk() ? SHOT_WIN : SHOT_SUNK;
+    if (shot.result >= SHOT_SUNK) sinkings.record(ship, row * BoardType::COLS + col, enemy_ships.getHitMask());
+    return shot;
+}
+
+template <class BoardType>
+void Sinkings<BoardType>::reset()
+{
+    for (int ship = 0; ship <= MAX_SHIP_NUM; ship++)
     {
-        if (my_ships.getNumRows() - row >= size)
-        {
-            for (int i = row; i < row + size; i++)
-            {
-                if (my_ships.getValue(i, col) != '-') return false;
-            }
-            for (int i = row; i < row + size; i++)
-            {
-                my_ships.updateBoard(i, col, 'S', size);
-            }
-        }
-        else return false;
+        m_cell[ship] = -1;
+        m_hits[ship].clear();
+        m_known[ship].clear();
     }
-    else if (direction == 'U') // Up
+    m_cells.clear();
+    m_ships = 0;
+}
+
+template <class BoardType>
+void Sinkings<BoardType>::record(int ship, int cell, const Mask &hits)
+{
+    m_cell[ship] = cell;
+    m_hits[ship] = hits;
+    m_known[ship].set(cell);
+    m_cells.set(cell);
+    m_ships |= 1u << ship;
+
+    const ShipShape<BoardType> *shapes[ShipShape<BoardType>::MAX_VARIANTS];
+    bool settled = true;
+    while (settled)
     {
-        if (row - size + 1 >= 0)
+        settled = false;
+        for (int s = 1; s <= MAX_SHIP_NUM; s++)
         {
-            for (int i = row; i >= row - size + 1; i--)
-            {
-                if (my_ships.getValue(i, col) != '-')
+            if (!((m_ships >> s) & 1)) continue;
+
+            // Every placement through the sinking cell on cells hit by then and not another ship's
+            Mask free = m_hits[s].andNot(m_cells.andNot(m_known[s]));
+            Mask sinking;
+            sinking.set(m_cell[s]);
+            Mask shared = Mask::full();
+            bool fits = false;
+            int numShapes = ShipShape<BoardType>::variants(s, shapes);
+            for (int v = 0; v < numShapes; v++)
+            {
+                Mask corners = shapes[v]->legalCorners(free) & shapes[v]->covering(sinking);
+                for (int corner = corners.first(); corner >= 0; corner = corners.first())
                 {
-                    //cout << "nope because " << my_ships.getValue(i, col);
-                    return false;
+                    corners.reset(corner);
+                    shared &= shapes[v]->cellsAt(corner);
+                    fits = true;
                 }
             }
-            for (int i = row; i >= row - size + 1; i--)
+            if (fits && shared.andNot(m_known[s]).any())
             {
-                my_ships.updateBoard(i, col, 'S', size);
+                m_known[s] |= shared;
+                m_cells |= shared;
+                settled = true;
             }
         }
-        else return false;
     }
-    return true;
-
 }
 
-bool Player::CheckHit(int row, int col)
-{
-    if (row > my_ships.getNumRows() - 1 || row < 0 || col > my_ships.getNumCols() - 1 || col < 0 || my_ships.getValue(row, col) == 'X') return false;
-
-    if (my_ships.getValue(row, col) == 'S')
-    {
-        my_ships.updateBoard(row, col, 'X');
-        return true;
-    }
-    return false;
-}
+template class Sinkings<NormalBoard>;
+template class Sinkings<XLBoard>;
+template class Player<NormalBoard>;
+template class Player<XLBoard>;
@@ -2,23 +2,136 @@
 #define PLAYER_H
 
 #include "board.h"
+#include "placement.h"
+#include "untried_cells.h"
 
+/**
+ * @brief The outcome of one shot
+ *
+ */
+enum ShotResult
+{
+    SHOT_MISS,
+    SHOT_HIT,
+    SHOT_SUNK,     // hit, and it was the last tile of that ship
+    SHOT_WIN,      // hit, and it was the last tile of the last ship
+    SHOT_INVALID   // off the board or already fired at; the turn does not pass
+};
+
+/**
+ * @brief What one shot did, as Player::Fire reports it
+ *
+ */
+struct Shot
+{
+    ShotResult result;
+    int ship;   // the number of the ship struck, or 0 for a miss or an invalid shot
+};
+
+/**
+ * @brief The enemy ships one side has sunk, as the game announced them, and the cells they must have covered
+ *
+ * The game says which ship sank and on which shot, but not where the rest of
+ * it was. Each sunk ship covered its sinking cell and only cells hit by then,
+ * and no cell known to be another sunk ship's; a cell every such placement
+ * covers was certainly the ship's. Ships are worked through again until no
+ * more cells are settled, so settling one can settle another. Hits which
+ * could still belong to a sunk ship or a floating one stay out of cells().
+ */
+template <class BoardType>
+class Sinkings
+{
+    public:
+        typedef typename BoardType::Mask Mask;
+
+        static const int MAX_SHIP_NUM = BoardLayers<BoardType::CELLS>::MAX_SHIP_NUM;
+
+        /**
+         * @brief Construct a record with no ship sunk
+         *
+         */
+        Sinkings() { reset(); }
+
+        /**
+         * @brief Forget every ship sunk
+         *
+         */
+        void reset();
+
+        /**
+         * @brief Note that a ship sank, and settle whatever cells that proves
+         *
+         * @param ship The ship's number, which is also its size
+         * @param cell The cell (row * numCols + col) of the shot which sank it
+         * @param hits Every hit made so far, that shot's included
+         */
+        void record(int ship, int cell, const Mask &hits);
+
+        /**
+         * @brief Get the cells known to belong to sunk ships
+         *
+         */
+        const Mask &cells() const { return m_cells; }
+
+        /**
+         * @brief Get the ships sunk, bit s set once ship s has sunk
+         *
+         */
+        unsigned ships() const { return m_ships; }
+
+    private:
+        int m_cell[MAX_SHIP_NUM + 1];     // indexed by ship number: the sinking shot's cell
+        Mask m_hits[MAX_SHIP_NUM + 1];    // the hits made by then
+        Mask m_known[MAX_SHIP_NUM + 1];   // the cells settled as the ship's
+        Mask m_cells;
+        unsigned m_ships;
+};
+
+extern template class Sinkings<NormalBoard>;
+extern template class Sinkings<XLBoard>;
+
+/**
+ * @brief What one side knows of the enemy board: its own marks there, and the ships it has sunk
+ *
+ * Nothing comes from the enemy's own board; the sunk ships are those of the
+ * side's Sinkings.
+ */
+template <class BoardType>
+struct EnemyView
+{
+    typename BoardType::Mask hits;
+    typename BoardType::Mask misses;
+    uint64_t marks;                  // the Zobrist hash of hits and misses, as Board::getHash keeps it
+    typename BoardType::Mask sunk;   // the cells known to belong to sunk ships (see Sinkings)
+    unsigned sunkShips;              // bit s is set once ship s has sunk
+    int numShips;
+    const UntriedCells<BoardType::CELLS> *untried;   // every cell in neither hits nor misses
+};
+
+/**
+ * @brief One side of a game, owning its own ships and its view of the enemy
+ *
+ * Templated on the board type (NormalBoard or XLBoard) and explicitly
+ * instantiated for both in player.cpp.
+ */
+template <class BoardType>
 class Player
 {
 	public:
         /**
          * @brief Construct a new Player
          * 
-         * @param big If the user has requested a XL board
          */
-		Player(bool big);
+		Player();
         /**
          * @brief Destroy the Player
          * 
          */
 		~Player();
-		Board my_ships;
-		Board enemy_ships;
+		BoardType my_ships;
+		BoardType enemy_ships;
+        UntriedCells<BoardType::CELLS> untried_cells; // cells of enemy_ships not fired at yet
+        Sinkings<BoardType> sinkings; // the enemy ships this player has sunk
 
 
         /**
@@ -35,22 +148,34 @@ class Player
          * @param size The size of the ship
          * @param row The row in which to place the ship
          * @param col The column in which to place the ship
-         * @param direction The direction to face the ship
+         * @param direction The direction to face the ship, or 'V' / 'N' for the bent size 7 / size 5 ship
+         * @param orientation Which way to turn a bent ship, 0 to 7 (see Orientations)
          * @return true Placement succeded
          * @return false Placement failed
          */
-		bool PlaceShip(int size, int row, int col, char direction); // will try to place a ship with upper left point at row, col; returns false if it cant
+		bool PlaceShip(int size, int row, int col, char direction, int orientation = 0); // will try to place a ship with its pivot at row, col; returns false if it cant
         /**
          * @brief Attempt to place the ship at the given point for the AI
          * 
          * @param size The size of the ship
          * @param row The row in which to place the ship
          * @param col The column in which to place the ship
-         * @param direction The direction to face the ship
+         * @param direction The direction to face the ship, as for PlaceShip
+         * @param orientation Which way to turn a bent ship, as for PlaceShip
          * @return true Placement succeded
          * @return false Placement failed
          */
-        bool PlaceShipAI(int size, int row, int col, char direction);
+        bool PlaceShipAI(int size, int row, int col, char direction, int orientation = 0);
+
+        /**
+         * @brief Find every pivot at which a ship could be placed right now
+         * 
+         * @param size The size of the ship
+         * @param direction The direction to face the ship, as for PlaceShip
+         * @param orientation Which way to turn a bent ship, as for PlaceShip
+         * @return BoardType::Mask The pivots (row * numCols + col) at which PlaceShip would succeed
+         */
+        typename BoardType::Mask LegalPlacements(int size, char direction, int orientation = 0);
 
         /**
          * @brief Print the player's board showing ships and enemy shots
@@ -75,7 +200,7 @@ class Player
 		bool CheckHit(int row, int col);
 
         /**
-         * @brief Update the enemy board with a hit or miss at the given location
+         * @brief Update the enemy board with a hit or miss at the given location, and remove it from untried_cells
          * 
          * @param row The row to update
          * @param col The column to update
@@ -83,9 +208,44 @@ class Player
          */
 		void UpdateEnemyBoard(int row, int col, bool hit);
 
+        /**
+         * @brief Fire at the defender: mark the shot on its my_ships and on this player's enemy_ships
+         * 
+         * Reads the target cell once and keeps the sunk checks to the board's
+         * counters, so a shot costs the same however far the game has gone.
+         * A ship sunk is noted in sinkings.
+         * 
+         * @param defender The player fired at
+         * @param row The row to fire at
+         * @param col The column to fire at
+         * @return Shot The outcome and the ship struck. SHOT_INVALID changes nothing.
+         */
+        Shot Fire(Player &defender, int row, int col);
+
 	private:
 		int numShips;
 };
 
+extern template class Player<NormalBoard>;
+extern template class Player<XLBoard>;
+
+/**
+ * @brief Get what the attacker knows of the defender's board
+ *
+ */
+template <class BoardType>
+EnemyView<BoardType> enemyView(Player<BoardType> &attacker, Player<BoardType> &defender)
+{
+    EnemyView<BoardType> view;
+    view.hits = attacker.enemy_ships.getHitMask();
+    view.misses = attacker.enemy_ships.getMissMask();
+    view.marks = attacker.enemy_ships.getHash();
+    view.sunk = attacker.sinkings.cells();
+    view.sunkShips = attacker.sinkings.ships();
+    view.numShips = defender.my_ships.getNumShips();
+    view.untried = &attacker.untried_cells;
+    return view;
+}
+
 
 #endif
@@ -0,0 +1,247 @@
+/*------------------------------------------------------------
+ * @Filename: query.cpp
+ * @Description: battleship-query, filters recorded games through their index and replays the matches
+ ------------------------------------------------------------*/
+
+#include "game_record.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Command line settings for a query; a field left at its "any" value does not filter
+ *
+ */
+struct QueryOptions
+{
+    string path;
+    char mode = 0;
+    int controllers[2] = {-1, -1};
+    int winner = 0;
+    int minShots = 0;
+    int maxShots = -1;
+    int ship = 0;           // the ship whose placement to filter on, if not 0
+    int shipDirection = -1; // its direction code
+    int shipOrientation = -1;
+    int shipSide = 0;       // 0 for either side
+    bool countOnly = false;
+    long limit = -1;
+    bool verify = false;
+};
+
+const char CONTROLLER_LETTERS[] = "?EMHX";   // indexed by Controller
+
+/**
+ * @brief Keep the candidates which pass a test, reading nothing but what the test reads
+ *
+ */
+template <class Test>
+void narrow(vector<size_t> &candidates, Test test)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        if (test(candidates[i])) candidates[kept++] = candidates[i];
+    }
+    candidates.resize(kept);
+}
+
+/**
+ * @brief Find the records an index says match the options, in file order
+ *
+ */
+vector<size_t> select(const RecordIndex &index, const QueryOptions &options)
+{
+    vector<size_t> candidates(index.size());
+    for (size_t i = 0; i < candidates.size(); i++) candidates[i] = i;
+
+    if (options.mode != 0)
+    {
+        const uint8_t *modes = index.modes();
+        narrow(candidates, [&](size_t i) { return modes[i] == options.mode; });
+    }
+    for (int side = 1; side <= 2; side++)
+    {
+        if (options.controllers[side - 1] < 0) continue;
+        const uint8_t *controllers = index.controllers(side);
+        int wanted = options.controllers[side - 1];
+        narrow(candidates, [&](size_t i) { return controllers[i] == wanted; });
+    }
+    if (options.winner != 0)
+    {
+        const uint8_t *winners = index.winners();
+        narrow(candidates, [&](size_t i) { return winners[i] == options.winner; });
+    }
+    if (options.minShots > 0 || options.maxShots >= 0)
+    {
+        const uint16_t *shots = index.winnerShots();
+        narrow(candidates, [&](size_t i) {
+            return shots[i] >= options.minShots && (options.maxShots < 0 || shots[i] <= options.maxShots);
+        });
+    }
+    if (options.ship != 0)
+    {
+        narrow(candidates, [&](size_t i) {
+            for (int side = 1; side <= 2; side++)
+            {
+                if (options.shipSide != 0 && side != options.shipSide) continue;
+                uint8_t code = index.shape(i, side, options.ship);
+                if (code == RecordSummary::NO_SHIP || code / 8 != options.shipDirection) continue;
+                if (options.shipOrientation < 0 || code % 8 == options.shipOrientation) return true;
+            }
+            return false;
+        });
+    }
+    return candidates;
+}
+
+/**
+ * @brief Replay a record through a GameEngine of its board
+ *
+ */
+bool replay(const GameRecordView &record)
+{
+    if (record.mode == 'X')
+    {
+        GameEngine<XLBoard> engine(record.numShips, record.controllers[0], record.controllers[1], record.seed);
+        return replayRecord(record, engine);
+    }
+    GameEngine<NormalBoard> engine(record.numShips, record.controllers[0], record.controllers[1], record.seed);
+    return replayRecord(record, engine);
+}
+
+void usage()
+{
+    cerr << "usage: battleship-query FILE [--mode N|X] [--p1 E|M|H|X] [--p2 E|M|H|X] [--winner 1|2]\n"
+         << "                        [--min-shots N] [--max-shots N] [--ship K:D[:O]] [--ship-side 1|2]\n"
+         << "                        [--count] [--limit N] [--verify]\n"
+         << "shots are the winner's; --ship K:D[:O] matches ship K placed facing D (U, D, L, R, V or N),\n"
+         << "turned to orientation O for a bent ship\n";
+    exit(1);
+}
+
+/**
+ * @brief Parse "K:D" or "K:D:O" into the ship filter
+ *
+ */
+void parseShip(const string &value, QueryOptions &options)
+{
+    size_t colon = value.find(':');
+    if (colon == string::npos || colon + 1 >= value.size()) usage();
+    const char *found = strchr(GameRecordFormat::DIRECTIONS, toupper(value[colon + 1]));
+    if (found == NULL || *found == '\0') usage();
+
+    options.ship = atoi(value.substr(0, colon).c_str());
+    options.shipDirection = found - GameRecordFormat::DIRECTIONS;
+    size_t second = value.find(':', colon + 1);
+    if (second != string::npos) options.shipOrientation = atoi(value.substr(second + 1).c_str());
+    if (options.ship < 1 || options.ship > RecordSummary::MAX_SHIP_NUM || options.shipOrientation > 7) usage();
+}
+
+int main(int argc, char **argv)
+{
+    QueryOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--count") { options.countOnly = true; continue; }
+        if (arg == "--verify") { options.verify = true; continue; }
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            if (!options.path.empty()) usage();
+            options.path = arg;
+            continue;
+        }
+        if (i + 1 >= argc) usage();
+        string value = argv[++i];
+
+        if (arg == "--mode") options.mode = toupper(value[0]);
+        else if (arg == "--p1" || arg == "--p2")
+        {
+            const char *letter = strchr(CONTROLLER_LETTERS + 1, toupper(value[0]));
+            if (letter == NULL || *letter == '\0') usage();
+            options.controllers[arg == "--p1" ? 0 : 1] = letter - CONTROLLER_LETTERS;
+        }
+        else if (arg == "--winner") options.winner = atoi(value.c_str());
+        else if (arg == "--min-shots") options.minShots = atoi(value.c_str());
+        else if (arg == "--max-shots") options.maxShots = atoi(value.c_str());
+        else if (arg == "--ship") parseShip(value, options);
+        else if (arg == "--ship-side") options.shipSide = atoi(value.c_str());
+        else if (arg == "--limit") options.limit = atol(value.c_str());
+        else usage();
+    }
+
+    if (options.path.empty() || (options.mode != 0 && options.mode != 'N' && options.mode != 'X') ||
+        options.winner < 0 || options.winner > 2 || options.shipSide < 0 || options.shipSide > 2)
+    {
+        usage();
+    }
+
+    GameRecordReader reader(options.path);
+    if (!reader.good())
+    {
+        cerr << "battleship-query: " << options.path << " is not a game-record file\n";
+        return 1;
+    }
+
+    // An index left from other records, or none at all, is rebuilt first
+    string indexPath = recordIndexPath(options.path);
+    RecordIndex *index = new RecordIndex(indexPath);
+    if (!index->covers(reader.size()))
+    {
+        delete index;
+        cerr << "battleship-query: indexing " << options.path << "\n";
+        if (!buildRecordIndex(options.path))
+        {
+            cerr << "battleship-query: cannot index " << options.path << "\n";
+            return 1;
+        }
+        index = new RecordIndex(indexPath);
+    }
+
+    vector<size_t> matches = select(*index, options);
+    if (options.countOnly && !options.verify)
+    {
+        cout << matches.size() << "\n";
+        delete index;
+        return 0;
+    }
+
+    long shown = 0, verified = 0, mismatched = 0;
+    GameRecordView record;
+    for (size_t m = 0; m < matches.size() && (options.limit < 0 || shown < options.limit); m++)
+    {
+        reader.seek(index->offsets()[matches[m]]);
+        if (!reader.next(record))
+        {
+            cerr << "battleship-query: corrupt record at byte " << index->offsets()[matches[m]] << "\n";
+            delete index;
+            return 1;
+        }
+        shown++;
+
+        bool replayed = true;
+        if (options.verify)
+        {
+            replayed = replay(record);
+            verified++;
+            if (!replayed) mismatched++;
+        }
+        if (options.countOnly) continue;
+
+        cout << "game " << record.index << " seed " << record.seed << " " << record.mode
+             << " " << CONTROLLER_LETTERS[record.controllers[0]] << "-" << CONTROLLER_LETTERS[record.controllers[1]]
+             << " winner " << record.winner << " shots " << index->winnerShots()[matches[m]]
+             << (replayed ? "" : " REPLAY MISMATCH") << "\n";
+    }
+
+    if (options.countOnly) cout << matches.size() << "\n";
+    if (options.verify) cerr << "replayed " << verified << ", mismatched " << mismatched << "\n";
+    delete index;
+    return mismatched == 0 ? 0 : 2;
+}
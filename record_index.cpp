@@ -0,0 +1,138 @@
+#include "record_index.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char MAGIC[8] = {'B', 'S', 'I', 'N', 'D', 'E', 'X', '1'};
+    const size_t HEADER_BYTES = sizeof(MAGIC) + 2 * sizeof(uint64_t);
+    const size_t SHAPE_BYTES = 2 * RecordSummary::MAX_SHIP_NUM;
+
+    size_t padded(size_t bytes) { return (bytes + 7) & ~static_cast<size_t>(7); }
+
+    /**
+     * @brief Get the size of each column for some number of records, in file order
+     *
+     */
+    void columnSizes(size_t count, size_t sizes[])
+    {
+        sizes[0] = padded(count * sizeof(uint64_t));
+        for (int i = 1; i <= 5; i++) sizes[i] = padded(count);
+        sizes[6] = padded(count * sizeof(uint16_t));
+        sizes[7] = padded(count * SHAPE_BYTES);
+    }
+
+    const int NUM_COLUMNS = 8;
+
+    bool writeColumn(FILE *file, const void *data, size_t bytes, size_t paddedBytes)
+    {
+        static const char zeros[8] = {0};
+        return (bytes == 0 || fwrite(data, 1, bytes, file) == bytes) &&
+               fwrite(zeros, 1, paddedBytes - bytes, file) == paddedBytes - bytes;
+    }
+}
+
+void RecordIndexBuilder::add(const RecordSummary &summary)
+{
+    m_offsets.push_back(summary.offset);
+    m_modes.push_back(summary.mode);
+    m_numShips.push_back(summary.numShips);
+    m_controllers[0].push_back(summary.controllers[0]);
+    m_controllers[1].push_back(summary.controllers[1]);
+    m_winners.push_back(summary.winner);
+    m_winnerShots.push_back(summary.winnerShots);
+    m_shapes.insert(m_shapes.end(), &summary.shapes[0][0], &summary.shapes[0][0] + SHAPE_BYTES);
+}
+
+bool RecordIndexBuilder::write(const std::string &path, uint64_t recordBytes) const
+{
+    // Written under a temporary name and renamed, so a reader never maps half an index
+    std::string partial = path + ".tmp";
+    FILE *file = fopen(partial.c_str(), "wb");
+    if (file == NULL) return false;
+
+    uint64_t count = m_offsets.size();
+    size_t sizes[NUM_COLUMNS];
+    columnSizes(count, sizes);
+
+    bool written = fwrite(MAGIC, 1, sizeof(MAGIC), file) == sizeof(MAGIC) &&
+                   fwrite(&count, sizeof(count), 1, file) == 1 &&
+                   fwrite(&recordBytes, sizeof(recordBytes), 1, file) == 1 &&
+                   writeColumn(file, m_offsets.data(), count * sizeof(uint64_t), sizes[0]) &&
+                   writeColumn(file, m_modes.data(), count, sizes[1]) &&
+                   writeColumn(file, m_numShips.data(), count, sizes[2]) &&
+                   writeColumn(file, m_controllers[0].data(), count, sizes[3]) &&
+                   writeColumn(file, m_controllers[1].data(), count, sizes[4]) &&
+                   writeColumn(file, m_winners.data(), count, sizes[5]) &&
+                   writeColumn(file, m_winnerShots.data(), count * sizeof(uint16_t), sizes[6]) &&
+                   writeColumn(file, m_shapes.data(), count * SHAPE_BYTES, sizes[7]);
+    written = fclose(file) == 0 && written;
+
+    if (!written || rename(partial.c_str(), path.c_str()) != 0)
+    {
+        remove(partial.c_str());
+        return false;
+    }
+    return true;
+}
+
+RecordIndex::RecordIndex(const std::string &path) : m_data(NULL), m_size(0), m_count(0), m_recordBytes(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= HEADER_BYTES)
+    {
+        mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) return;
+
+    const uint8_t *data = static_cast<const uint8_t *>(mapped);
+    size_t size = info.st_size;
+    uint64_t count;
+    memcpy(&count, data + sizeof(MAGIC), sizeof(count));
+    memcpy(&m_recordBytes, data + sizeof(MAGIC) + sizeof(count), sizeof(m_recordBytes));
+
+    size_t sizes[NUM_COLUMNS];
+    columnSizes(count, sizes);
+    size_t expected = HEADER_BYTES;
+    for (int i = 0; i < NUM_COLUMNS; i++) expected += sizes[i];
+    if (memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || count > size || expected != size)
+    {
+        munmap(mapped, size);
+        return;
+    }
+
+    m_data = data;
+    m_size = size;
+    m_count = count;
+
+    const uint8_t *column = data + HEADER_BYTES;
+    m_offsets = reinterpret_cast<const uint64_t *>(column);
+    column += sizes[0];
+    m_modes = column;
+    column += sizes[1];
+    m_numShips = column;
+    column += sizes[2];
+    m_controllers[0] = column;
+    column += sizes[3];
+    m_controllers[1] = column;
+    column += sizes[4];
+    m_winners = column;
+    column += sizes[5];
+    m_winnerShots = reinterpret_cast<const uint16_t *>(column);
+    column += sizes[6];
+    m_shapes = column;
+}
+
+RecordIndex::~RecordIndex()
+{
+    if (m_data != NULL) munmap(const_cast<uint8_t *>(m_data), m_size);
+}
@@ -0,0 +1,153 @@
+/*------------------------------------------------------------
+ * @Filename: record_index.h
+ * @Description: a sidecar index of a game-record file, one column per summary field
+ ------------------------------------------------------------*/
+
+#ifndef RECORD_INDEX_H
+#define RECORD_INDEX_H
+
+#include "board.h"
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ * Index layout, next to the records as <records>.idx, in host byte order (it
+ * is a cache, rebuilt from the records whenever it is missing or stale):
+ *
+ *   the 8 bytes "BSINDEX1"
+ *   uint64 number of records, uint64 size of the record file it describes
+ *   columns, each one entry per record and padded to 8 bytes:
+ *       uint64 offset of the record in the record file
+ *       uint8 mode, uint8 number of ships, uint8 controller of side 1,
+ *       uint8 controller of side 2, uint8 winner
+ *       uint16 number of shots fired by the winner
+ *       uint8[2][MAX_SHIP_NUM] each side's ships, direction code * 8 + orientation, 0xFF past the last ship
+ *
+ * A query scans only the columns it filters on and reads only the records
+ * which match.
+ */
+
+/**
+ * @brief The indexed fields of one record
+ *
+ */
+struct RecordSummary
+{
+    static const int MAX_SHIP_NUM = BoardLayers<XLBoard::CELLS>::MAX_SHIP_NUM;
+    static const uint8_t NO_SHIP = 0xFF;
+
+    uint64_t offset;
+    uint8_t mode;
+    uint8_t numShips;
+    uint8_t controllers[2];
+    uint8_t winner;
+    uint16_t winnerShots;
+    uint8_t shapes[2][MAX_SHIP_NUM];   // index 0 is ship 1
+};
+
+/**
+ * @brief Collects summaries as records are written and saves them as an index
+ *
+ */
+class RecordIndexBuilder
+{
+    public:
+        void add(const RecordSummary &summary);
+
+        /**
+         * @brief Write the index
+         *
+         * @param path The index file
+         * @param recordBytes The size of the record file the summaries describe
+         * @return true The index was written
+         * @return false It could not be
+         */
+        bool write(const std::string &path, uint64_t recordBytes) const;
+
+        size_t size() const { return m_offsets.size(); }
+
+    private:
+        std::vector<uint64_t> m_offsets;
+        std::vector<uint8_t> m_modes;
+        std::vector<uint8_t> m_numShips;
+        std::vector<uint8_t> m_controllers[2];
+        std::vector<uint8_t> m_winners;
+        std::vector<uint16_t> m_winnerShots;
+        std::vector<uint8_t> m_shapes;   // 2 * MAX_SHIP_NUM per record
+};
+
+/**
+ * @brief Maps an index read-only and hands out its columns
+ *
+ */
+class RecordIndex
+{
+    public:
+        /**
+         * @brief Map an index
+         *
+         * @param path The index file
+         */
+        explicit RecordIndex(const std::string &path);
+
+        /**
+         * @brief Unmap the index
+         *
+         */
+        ~RecordIndex();
+
+        /**
+         * @brief Check whether the index mapped and is whole
+         *
+         */
+        bool good() const { return m_data != NULL; }
+
+        /**
+         * @brief Check whether the index describes a record file of some size
+         *
+         * @param recordBytes The size of the record file now
+         */
+        bool covers(uint64_t recordBytes) const { return good() && m_recordBytes == recordBytes; }
+
+        size_t size() const { return m_count; }
+
+        const uint64_t *offsets() const { return m_offsets; }
+        const uint8_t *modes() const { return m_modes; }
+        const uint8_t *numShips() const { return m_numShips; }
+        const uint8_t *controllers(int side) const { return m_controllers[side - 1]; }
+        const uint8_t *winners() const { return m_winners; }
+        const uint16_t *winnerShots() const { return m_winnerShots; }
+
+        /**
+         * @brief Get the shape code of one ship of one record
+         *
+         * @param record The record's place in the index
+         * @param side The side (1 or 2)
+         * @param ship The ship (1 to MAX_SHIP_NUM)
+         * @return uint8_t Direction code * 8 + orientation, or RecordSummary::NO_SHIP
+         */
+        uint8_t shape(size_t record, int side, int ship) const
+        {
+            return m_shapes[record * 2 * RecordSummary::MAX_SHIP_NUM + (side - 1) * RecordSummary::MAX_SHIP_NUM + ship - 1];
+        }
+
+    private:
+        RecordIndex(const RecordIndex &);
+        RecordIndex &operator=(const RecordIndex &);
+
+        const uint8_t *m_data;
+        size_t m_size;
+        size_t m_count;
+        uint64_t m_recordBytes;
+        const uint64_t *m_offsets;
+        const uint8_t *m_modes;
+        const uint8_t *m_numShips;
+        const uint8_t *m_controllers[2];
+        const uint8_t *m_winners;
+        const uint16_t *m_winnerShots;
+        const uint8_t *m_shapes;
+};
+
+#endif
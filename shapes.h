@@ -0,0 +1,133 @@
+/*------------------------------------------------------------
+ * @Filename: shapes.h
+ * @Description: polyomino ship shapes and their rotations and reflections, built at compile time
+ ------------------------------------------------------------*/
+
+#ifndef SHAPES_H
+#define SHAPES_H
+
+/**
+ * @brief One cell of a shape, relative to the pivot the player picks
+ *
+ */
+struct ShapeCell
+{
+    int row;
+    int col;
+};
+
+/**
+ * @brief A polyomino of up to MAX_CELLS cells; cells[0] is the pivot at (0, 0)
+ *
+ */
+struct Polyomino
+{
+    static const int MAX_CELLS = 10;
+
+    int numCells;
+    ShapeCell cells[MAX_CELLS];
+};
+
+/**
+ * @brief All eight orientations of one polyomino
+ *
+ * Orientation o is the base shape mirrored left to right if o >= 4, then turned
+ * a quarter turn clockwise o % 4 times. Some shapes look the same in several
+ * orientations; ShipShape drops the repeats when it builds its masks.
+ */
+struct Orientations
+{
+    static const int COUNT = 8;
+
+    Polyomino shapes[COUNT];
+};
+
+namespace shapes
+{
+    // index packs for expanding the tables below, which std::index_sequence does from C++14 on
+    template <int... I> struct Indices {};
+    template <int N, int... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+    template <int... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+    typedef MakeIndices<Polyomino::MAX_CELLS>::type CellIndices;
+    typedef MakeIndices<Orientations::COUNT>::type OrientationIndices;
+
+    constexpr ShapeCell mirror(ShapeCell c, bool flip) { return flip ? ShapeCell{c.row, -c.col} : c; }
+
+    constexpr ShapeCell turn(ShapeCell c, int quarters)
+    {
+        return quarters == 0 ? c : turn(ShapeCell{c.col, -c.row}, quarters - 1);
+    }
+
+    constexpr ShapeCell orient(ShapeCell c, int orientation)
+    {
+        return turn(mirror(c, orientation >= 4), orientation % 4);
+    }
+
+    template <int... I>
+    constexpr Polyomino orientShape(const Polyomino &base, int orientation, Indices<I...>)
+    {
+        return Polyomino{base.numCells, {orient(base.cells[I], orientation)...}};
+    }
+
+    template <int... O>
+    constexpr Orientations allOrientations(const Polyomino &base, Indices<O...>)
+    {
+        return Orientations{{orientShape(base, O, CellIndices())...}};
+    }
+
+    template <int... I>
+    constexpr Polyomino line(int length, Indices<I...>)
+    {
+        // cells past the end repeat the pivot and are ignored
+        return Polyomino{length, {ShapeCell{I < length ? I : 0, 0}...}};
+    }
+
+    constexpr Orientations orientationsOf(const Polyomino &base)
+    {
+        return allOrientations(base, OrientationIndices());
+    }
+
+    constexpr Orientations lineOrientations(int length)
+    {
+        return orientationsOf(line(length, CellIndices()));
+    }
+
+    // Ship 7 may be a V: four cells down from the pivot and three more to its right
+    constexpr Polyomino V_SHAPE = {7, {{0, 0}, {1, 0}, {2, 0}, {3, 0}, {0, 1}, {0, 2}, {0, 3}}};
+
+    // Ship 5 may be an N: the pivot and the cell below it, two cells to the right, and the cell below the last
+    constexpr Polyomino N_SHAPE = {5, {{0, 0}, {1, 0}, {0, 1}, {0, 2}, {1, 2}}};
+}
+
+/**
+ * @brief The orientations of every shape in the game, computed by the compiler
+ *
+ * A line's orientation 0 runs down from the pivot and each quarter turn takes
+ * it to the next of 'D', 'L', 'U', 'R'.
+ */
+struct ShapeTable
+{
+    static const int MAX_LENGTH = Polyomino::MAX_CELLS;
+
+    Orientations lines[MAX_LENGTH + 1];   // by length; lines[0] is unused
+    Orientations v;
+    Orientations n;
+};
+
+constexpr ShapeTable SHAPE_TABLE = {
+    {
+        shapes::lineOrientations(0), shapes::lineOrientations(1), shapes::lineOrientations(2),
+        shapes::lineOrientations(3), shapes::lineOrientations(4), shapes::lineOrientations(5),
+        shapes::lineOrientations(6), shapes::lineOrientations(7), shapes::lineOrientations(8),
+        shapes::lineOrientations(9), shapes::lineOrientations(10)
+    },
+    shapes::orientationsOf(shapes::V_SHAPE),
+    shapes::orientationsOf(shapes::N_SHAPE)
+};
+
+// The table really is built by the compiler, and a quarter turn of a line going down goes left
+static_assert(SHAPE_TABLE.lines[3].shapes[1].cells[2].col == -2, "a quarter turn of 'D' should be 'L'");
+static_assert(SHAPE_TABLE.v.shapes[4].cells[6].col == -3, "the mirrored V should open to the left");
+
+#endif
@@ -0,0 +1,354 @@
+/*------------------------------------------------------------
+ * @Filename: simulate.cpp
+ * @Description: battleship-sim, plays many AI vs AI games across all cores
+ ------------------------------------------------------------*/
+
+#include "game_engine.h"
+#include "batch_engine.h"
+#include "game_record.h"
+#include "game_stats.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Command line settings for a simulation run
+ *
+ */
+struct SimOptions
+{
+    long games = 10000;
+    char mode = 'N';
+    int ships = 5;
+    char difficulty[2] = {'E', 'E'};
+    int threads = 0;
+    long batch = 256;   // games per task handed to the pool
+    uint64_t seed = static_cast<uint64_t>(time(NULL));
+    int expertSamples = 2000;
+    int expertMilliseconds = 0;   // no time limit, so expert games stay reproducible
+    string recordPath;            // where to record every game, if set
+    string jsonPath;              // where to write the results as JSON, if set
+    bool batchEngine = false;     // play BatchEngine::LANES games at a time in a BatchEngine
+};
+
+/**
+ * @brief The seed of one game, so that any game in a run can be replayed on its own
+ *
+ * @param baseSeed The seed of the whole run
+ * @param game The index of the game in the run
+ * @return uint64_t The game's seed (splitmix64 of the pair)
+ */
+uint64_t gameSeed(uint64_t baseSeed, long game)
+{
+    uint64_t z = baseSeed + 0x9E3779B97F4A7C15ULL * static_cast<uint64_t>(game + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Apply the options which concern a strategy; most have none
+ *
+ */
+template <class Strategy>
+void configure(Strategy &, const SimOptions &) {}
+
+template <class BoardType>
+void configure(ExpertStrategy<BoardType> &strategy, const SimOptions &options)
+{
+    strategy.setBudget(options.expertSamples, options.expertMilliseconds);
+}
+
+/**
+ * @brief Play games first to first + count - 1 on the calling thread and add them to results
+ *
+ * The strategies are fixed at compile time, so playGame runs with no
+ * dispatch per shot. They are built once and reset for every game.
+ *
+ * @param writer Where to record the games, or NULL
+ */
+template <class BoardType, class First, class Second>
+void playGames(const SimOptions &options, long first, long count, GameStats<BoardType> &results, GameRecordWriter *writer)
+{
+    GameRecorder *recorder = writer == NULL ? NULL : new GameRecorder(*writer);
+    GameOutcome<BoardType> outcome;
+    First firstStrategy;
+    Second secondStrategy;
+    configure(firstStrategy, options);
+    configure(secondStrategy, options);
+
+    for (long game = first; game < first + count; game++)
+    {
+        uint64_t seed = gameSeed(options.seed, game);
+        GameEngine<BoardType> engine(options.ships, controllerForDifficulty(options.difficulty[0]),
+                                     controllerForDifficulty(options.difficulty[1]), seed);
+        engine.placeFleet(1);
+        engine.placeFleet(2);
+        firstStrategy.reset(seed, 1);
+        secondStrategy.reset(seed, 2);
+        if (recorder != NULL) recorder->begin(engine, game);
+        outcome.reset();
+
+        outcome.winner = playGame(engine, firstStrategy, secondStrategy, [&](int side, int cell, const Shot &shot) {
+            int sunk = shot.result == SHOT_SUNK || shot.result == SHOT_WIN ? shot.ship : 0;
+            outcome.shot(side, cell, shot.result, sunk);
+            if (recorder != NULL) recorder->shot(side, cell, shot.result);
+        });
+
+        results.add(outcome);
+        if (recorder != NULL) recorder->finish(outcome.winner);
+    }
+    delete recorder;   // sends its last records
+}
+
+/**
+ * @brief Play games first to first + count - 1 in a BatchEngine, BatchEngine::LANES at a time, and add them to results
+ *
+ * First and Second are mask-based strategies (see strategy.h), one per
+ * lane, and the games come out as playGames plays them: the same shots,
+ * added to results in game order.
+ */
+template <class First, class Second>
+void playGamesBatched(const SimOptions &options, long first, long count, GameStats<NormalBoard> &results)
+{
+    const int LANES = BatchEngine::LANES;
+    BatchEngine engine(options.ships);
+    vector<First> firstStrategies(LANES);
+    vector<Second> secondStrategies(LANES);
+    GameOutcome<NormalBoard> outcomes[LANES];
+    uint64_t seeds[LANES];
+
+    for (long game = first; game < first + count; game += LANES)
+    {
+        int lanes = first + count - game < LANES ? static_cast<int>(first + count - game) : LANES;
+        for (int lane = 0; lane < lanes; lane++)
+        {
+            seeds[lane] = gameSeed(options.seed, game + lane);
+            outcomes[lane].reset();
+        }
+
+        playBatch(engine, seeds, lanes, firstStrategies.data(), secondStrategies.data(), [&](int lane, int side, int cell, const Shot &shot) {
+            int sunk = shot.result == SHOT_SUNK || shot.result == SHOT_WIN ? shot.ship : 0;
+            outcomes[lane].shot(side, cell, shot.result, sunk);
+        });
+
+        for (int lane = 0; lane < lanes; lane++)
+        {
+            outcomes[lane].winner = engine.getWinner(lane);
+            results.add(outcomes[lane]);
+        }
+    }
+}
+
+/**
+ * @brief Call playGamesBatched with the mask-based strategies both sides' difficulties name
+ *
+ */
+void playGamesBatchedBetween(const SimOptions &options, long first, long count, GameStats<NormalBoard> &results)
+{
+    typedef EasyStrategy<NormalBoard> Easy;
+    typedef HardStrategy<NormalBoard> Hard;
+    bool hardFirst = options.difficulty[0] == 'H';
+    bool hardSecond = options.difficulty[1] == 'H';
+    if (hardFirst && hardSecond) playGamesBatched<Hard, Hard>(options, first, count, results);
+    else if (hardFirst) playGamesBatched<Hard, Easy>(options, first, count, results);
+    else if (hardSecond) playGamesBatched<Easy, Hard>(options, first, count, results);
+    else playGamesBatched<Easy, Easy>(options, first, count, results);
+}
+
+// main() only allows the batch engine on 9x9 boards
+template <class BoardType>
+void playGamesBatchedBetween(const SimOptions &, long, long, GameStats<BoardType> &) {}
+
+/**
+ * @brief Call playGames with side 1 playing First and side 2 the strategy its difficulty names
+ *
+ */
+template <class BoardType, class First>
+void playGamesAgainst(const SimOptions &options, long first, long count, GameStats<BoardType> &results, GameRecordWriter *writer)
+{
+    switch (options.difficulty[1])
+    {
+        case 'E': playGames<BoardType, First, EasyStrategy<BoardType> >(options, first, count, results, writer); break;
+        case 'M': playGames<BoardType, First, MediumStrategy<BoardType> >(options, first, count, results, writer); break;
+        case 'H': playGames<BoardType, First, HardStrategy<BoardType> >(options, first, count, results, writer); break;
+        default: playGames<BoardType, First, ExpertStrategy<BoardType> >(options, first, count, results, writer); break;
+    }
+}
+
+/**
+ * @brief Call playGames with the strategies both sides' difficulties name
+ *
+ */
+template <class BoardType>
+void playGamesBetween(const SimOptions &options, long first, long count, GameStats<BoardType> &results, GameRecordWriter *writer)
+{
+    if (options.batchEngine)
+    {
+        playGamesBatchedBetween(options, first, count, results);
+        return;
+    }
+    switch (options.difficulty[0])
+    {
+        case 'E': playGamesAgainst<BoardType, EasyStrategy<BoardType> >(options, first, count, results, writer); break;
+        case 'M': playGamesAgainst<BoardType, MediumStrategy<BoardType> >(options, first, count, results, writer); break;
+        case 'H': playGamesAgainst<BoardType, HardStrategy<BoardType> >(options, first, count, results, writer); break;
+        default: playGamesAgainst<BoardType, ExpertStrategy<BoardType> >(options, first, count, results, writer); break;
+    }
+}
+
+void printResults(const SimOptions &options, uint64_t games, int threads, double seconds)
+{
+    cout << "games:        " << games << " (" << options.mode << " board, " << options.ships << " ships)\n";
+    cout << "seed:         " << options.seed << "\n";
+    cout << "threads:      " << threads << "\n";
+    if (options.batchEngine) cout << "engine:       batch (" << BatchEngine::LANES << " lanes, " << BatchEngine::kernelName() << ")\n";
+    cout << "time:         " << seconds << " s (" << games / seconds << " games/s)\n";
+}
+
+/**
+ * @brief Write the run's settings and results to a JSON file
+ *
+ * @return true The file was written
+ */
+template <class BoardType>
+bool writeJson(const SimOptions &options, const GameStats<BoardType> &results, int threads, double seconds)
+{
+    ofstream out(options.jsonPath.c_str());
+    out << "{\"mode\": \"" << options.mode << "\", \"ships\": " << options.ships
+        << ", \"p1\": \"" << options.difficulty[0] << "\", \"p2\": \"" << options.difficulty[1] << "\""
+        << ", \"seed\": " << options.seed << ", \"threads\": " << threads << ", \"seconds\": " << seconds
+        << ",\n\"results\": ";
+    results.writeJson(out);
+    out << "}\n";
+    out.close();
+    return !out.fail();
+}
+
+template <class BoardType>
+void runSimulation(const SimOptions &options)
+{
+    GameRecordWriter *writer = NULL;
+    if (!options.recordPath.empty())
+    {
+        writer = new GameRecordWriter(options.recordPath);
+        if (!writer->good())
+        {
+            cerr << "battleship-sim: cannot write " << options.recordPath << "\n";
+            exit(1);
+        }
+    }
+
+    ThreadPool pool(options.threads);
+    vector<GameStats<BoardType> > perWorker(pool.getNumThreads());
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (long first = 0; first < options.games; first += options.batch)
+    {
+        long count = options.games - first < options.batch ? options.games - first : options.batch;
+        pool.submit([&options, &perWorker, writer, first, count]() {
+            playGamesBetween<BoardType>(options, first, count, perWorker[ThreadPool::currentWorker()], writer);
+        });
+    }
+    pool.wait();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (writer != NULL)
+    {
+        bool written = writer->close();
+        delete writer;
+        if (!written)
+        {
+            cerr << "battleship-sim: writing " << options.recordPath << " failed\n";
+            exit(1);
+        }
+    }
+
+    GameStats<BoardType> total;
+    for (size_t i = 0; i < perWorker.size(); i++) total.merge(perWorker[i]);
+    printResults(options, total.games(), pool.getNumThreads(), seconds);
+
+    string names[2];
+    const char *nameTexts[2];
+    for (int side = 0; side < 2; side++)
+    {
+        names[side] = string("side ") + char('1' + side) + " (" + options.difficulty[side] + ")";
+        nameTexts[side] = names[side].c_str();
+    }
+    total.print(cout, nameTexts);
+
+    if (!options.jsonPath.empty() && !writeJson(options, total, pool.getNumThreads(), seconds))
+    {
+        cerr << "battleship-sim: cannot write " << options.jsonPath << "\n";
+        exit(1);
+    }
+}
+
+void usage()
+{
+    cerr << "usage: battleship-sim [--games N] [--mode N|X] [--ships K] [--p1 E|M|H|X] [--p2 E|M|H|X]\n"
+         << "                      [--threads T] [--batch B] [--seed S] [--expert-samples N] [--expert-ms T]\n"
+         << "                      [--record FILE] [--json FILE] [--engine scalar|batch]\n"
+         << "--engine batch plays 9x9 games between Easy and Hard in SIMD lanes, without --record\n";
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    SimOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc) usage();
+        string value = argv[++i];
+
+        if (arg == "--games") options.games = atol(value.c_str());
+        else if (arg == "--mode") options.mode = toupper(value[0]);
+        else if (arg == "--ships") options.ships = atoi(value.c_str());
+        else if (arg == "--p1" || arg == "--p2")
+        {
+            const char *found = value.size() == 1 ? strchr("EMHX", toupper(value[0])) : NULL;
+            if (found == NULL || *found == '\0') usage();
+            options.difficulty[arg == "--p1" ? 0 : 1] = *found;
+        }
+        else if (arg == "--threads") options.threads = atoi(value.c_str());
+        else if (arg == "--batch") options.batch = atol(value.c_str());
+        else if (arg == "--seed") options.seed = strtoull(value.c_str(), NULL, 10);
+        else if (arg == "--expert-samples") options.expertSamples = atoi(value.c_str());
+        else if (arg == "--expert-ms") options.expertMilliseconds = atoi(value.c_str());
+        else if (arg == "--record") options.recordPath = value;
+        else if (arg == "--json") options.jsonPath = value;
+        else if (arg == "--engine" && (value == "scalar" || value == "batch")) options.batchEngine = value == "batch";
+        else usage();
+    }
+
+    int maxShips = options.mode == 'X' ? 10 : 5;
+    if ((options.mode != 'N' && options.mode != 'X') || options.ships < 1 || options.ships > maxShips ||
+        options.games < 1 || options.batch < 1 || options.expertSamples < 1)
+    {
+        usage();
+    }
+    if (options.batchEngine && (options.mode != 'N' || !strchr("EH", options.difficulty[0]) || !strchr("EH", options.difficulty[1]) || !options.recordPath.empty()))
+    {
+        usage();
+    }
+
+    if (options.mode == 'X')
+    {
+        runSimulation<XLBoard>(options);
+    }
+    else
+    {
+        runSimulation<NormalBoard>(options);
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "stats.h"
+
+#ifdef BATTLESHIP_STATS
+
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    const char *const NAMES[stats::COUNTER_COUNT] = {
+        "place_ship_attempts",
+        "place_ship_failures",
+        "place_ship_ai_attempts",
+        "place_ship_ai_failures",
+        "fleet_rejections",
+        "fleet_backtracks",
+        "random_shots",
+        "medium_give_ups",
+        "medium_cells_scanned",
+        "heatmap_cells_updated",
+        "expert_fleets_sampled",
+        "all_ships_sunk_calls",
+        "transposition_probes",
+        "transposition_hits",
+        "endgame_searches",
+        "endgame_nodes",
+        "ai_decisions_easy",
+        "ai_decisions_medium",
+        "ai_decisions_hard",
+        "ai_decisions_expert",
+        "ai_nanoseconds_easy",
+        "ai_nanoseconds_medium",
+        "ai_nanoseconds_hard",
+        "ai_nanoseconds_expert"
+    };
+
+    /**
+     * @brief The live threads' counters and the totals of the threads which have exited
+     *
+     * Never destroyed, so threads which exit during static destruction can still fold their counts in.
+     */
+    struct Registry
+    {
+        std::mutex lock;
+        std::vector<stats::ThreadCounters *> live;
+        uint64_t retired[stats::COUNTER_COUNT] = {0};
+        bool dumpsAtExit = false;
+    };
+
+    Registry &registry()
+    {
+        static Registry *shared = new Registry;
+        return *shared;
+    }
+
+    void dumpAtExit()
+    {
+        stats::dump(std::cerr);
+    }
+}
+
+namespace stats
+{
+    ThreadCounters::ThreadCounters()
+    {
+        for (int i = 0; i < COUNTER_COUNT; i++) values[i].store(0, std::memory_order_relaxed);
+
+        Registry &shared = registry();
+        std::lock_guard<std::mutex> guard(shared.lock);
+        if (!shared.dumpsAtExit) shared.dumpsAtExit = std::atexit(dumpAtExit) == 0;
+        shared.live.push_back(this);
+    }
+
+    ThreadCounters::~ThreadCounters()
+    {
+        Registry &shared = registry();
+        std::lock_guard<std::mutex> guard(shared.lock);
+        for (int i = 0; i < COUNTER_COUNT; i++) shared.retired[i] += values[i].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < shared.live.size(); i++)
+        {
+            if (shared.live[i] == this)
+            {
+                shared.live[i] = shared.live.back();
+                shared.live.pop_back();
+                break;
+            }
+        }
+    }
+
+    ThreadCounters &local()
+    {
+        thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    void snapshot(uint64_t totals[])
+    {
+        Registry &shared = registry();
+        std::lock_guard<std::mutex> guard(shared.lock);
+        for (int i = 0; i < COUNTER_COUNT; i++) totals[i] = shared.retired[i];
+        for (size_t t = 0; t < shared.live.size(); t++)
+        {
+            for (int i = 0; i < COUNTER_COUNT; i++) totals[i] += shared.live[t]->values[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    void dump(std::ostream &out)
+    {
+        uint64_t totals[COUNTER_COUNT];
+        snapshot(totals);
+
+        out << "stats:\n";
+        for (int i = 0; i < COUNTER_COUNT; i++) out << "  " << NAMES[i] << " " << totals[i] << "\n";
+
+        const char *difficulties[] = {"easy", "medium", "hard", "expert"};
+        for (int d = 0; d < 4; d++)
+        {
+            uint64_t decisions = totals[AI_DECISIONS_EASY + d];
+            if (decisions == 0) continue;
+            out << "  ai_mean_ns_" << difficulties[d] << " "
+                << static_cast<double>(totals[AI_NANOSECONDS_EASY + d]) / decisions << "\n";
+        }
+        out.flush();
+    }
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*------------------------------------------------------------
+ * @Filename: stats.h
+ * @Description: hot-path event counters and phase timers, compiled out unless BATTLESHIP_STATS is defined
+ ------------------------------------------------------------*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#ifdef BATTLESHIP_STATS
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace stats
+{
+    /**
+     * @brief Every event counted; the AI entries run in Controller order from EASY_AI
+     *
+     */
+    enum Counter
+    {
+        PLACE_SHIP_ATTEMPTS,
+        PLACE_SHIP_FAILURES,
+        PLACE_SHIP_AI_ATTEMPTS,
+        PLACE_SHIP_AI_FAILURES,
+        FLEET_REJECTIONS,       // a random fleet drawn ship by ship overlapped itself and was thrown away
+        FLEET_BACKTRACKS,       // a ship of a random fleet had nowhere to go
+        RANDOM_SHOTS,           // untried cells drawn by Easy, and by Medium when hunting
+        MEDIUM_GIVE_UPS,        // Medium::chooseShot found no shot and MediumStrategy fired at random instead
+        MEDIUM_CELLS_SCANNED,   // neighbours Medium looked at while tracing a hit ship
+        HEATMAP_CELLS_UPDATED,  // per-cell count changes in Hard's heatmap
+        EXPERT_FLEETS_SAMPLED,
+        ALL_SHIPS_SUNK_CALLS,
+        TRANSPOSITION_PROBES,   // AI positions looked up in a TranspositionTable
+        TRANSPOSITION_HITS,
+        ENDGAME_SEARCHES,       // Endgame positions with few enough fleets to search
+        ENDGAME_NODES,
+        AI_DECISIONS_EASY,
+        AI_DECISIONS_MEDIUM,
+        AI_DECISIONS_HARD,
+        AI_DECISIONS_EXPERT,
+        AI_NANOSECONDS_EASY,
+        AI_NANOSECONDS_MEDIUM,
+        AI_NANOSECONDS_HARD,
+        AI_NANOSECONDS_EXPERT,
+        COUNTER_COUNT
+    };
+
+    /**
+     * @brief One thread's counters
+     *
+     * Only the owning thread writes them, so an increment is a relaxed load and
+     * store rather than a locked add; the atomics only make reading them from
+     * another thread in dump() well defined.
+     */
+    struct ThreadCounters
+    {
+        std::atomic<uint64_t> values[COUNTER_COUNT];
+
+        ThreadCounters();
+        ~ThreadCounters();   // folds the counts into the process totals
+    };
+
+    /**
+     * @brief Get the calling thread's counters, registering them on first use
+     *
+     */
+    ThreadCounters &local();
+
+    inline void add(Counter counter, uint64_t amount)
+    {
+        std::atomic<uint64_t> &value = local().values[counter];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sum every thread's counters, including threads which have exited
+     *
+     * @param totals Filled with COUNTER_COUNT sums
+     */
+    void snapshot(uint64_t totals[]);
+
+    /**
+     * @brief Print the totals, one "name value" line per counter, plus the mean AI decision times
+     *
+     * Called at exit once anything has been counted; may also be called at any time.
+     *
+     * @param out Where to print
+     */
+    void dump(std::ostream &out);
+
+    /**
+     * @brief Times a scope and adds one call and the elapsed nanoseconds to two counters
+     *
+     */
+    class Timer
+    {
+        public:
+            Timer(Counter calls, Counter nanoseconds)
+                : m_calls(calls), m_nanoseconds(nanoseconds), m_start(std::chrono::steady_clock::now()) {}
+
+            ~Timer()
+            {
+                add(m_calls, 1);
+                add(m_nanoseconds, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+            }
+
+        private:
+            Counter m_calls;
+            Counter m_nanoseconds;
+            std::chrono::steady_clock::time_point m_start;
+    };
+}
+
+#define STATS_ADD(counter, amount) stats::add(stats::counter, (amount))
+#define STATS_COUNT(counter) stats::add(stats::counter, 1)
+#define STATS_COUNT_AT(counter, offset) stats::add(static_cast<stats::Counter>(stats::counter + (offset)), 1)
+#define STATS_TIMER(name, calls, nanoseconds, offset) \
+    stats::Timer name(static_cast<stats::Counter>(stats::calls + (offset)), static_cast<stats::Counter>(stats::nanoseconds + (offset)))
+
+#else
+
+#define STATS_ADD(counter, amount) ((void)0)
+#define STATS_COUNT(counter) ((void)0)
+#define STATS_COUNT_AT(counter, offset) ((void)0)
+#define STATS_TIMER(name, calls, nanoseconds, offset) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+#include "strategy.h"
+
+Controller controllerForDifficulty(char difficulty)
+{
+    if (difficulty == 'E') return EASY_AI;
+    if (difficulty == 'M') return MEDIUM_AI;
+    if (difficulty == 'X') return EXPERT_AI;
+    return HARD_AI;
+}
+
+template <class BoardType>
+AnyStrategy<BoardType>::AnyStrategy() : m_controller(EASY_AI) {}
+
+template <class BoardType>
+void AnyStrategy<BoardType>::setController(Controller controller) { m_controller = controller; }
+
+template <class BoardType>
+void AnyStrategy<BoardType>::setExpertBudget(int samples, int milliseconds) { m_expert.setBudget(samples, milliseconds); }
+
+template <class BoardType>
+void AnyStrategy<BoardType>::reset(uint64_t seed, int side)
+{
+    switch (m_controller)
+    {
+        case MEDIUM_AI: m_medium.reset(seed, side); break;
+        case HARD_AI: m_hard.reset(seed, side); break;
+        case EXPERT_AI: m_expert.reset(seed, side); break;
+        default: m_easy.reset(seed, side); break;
+    }
+}
+
+template <class BoardType>
+int AnyStrategy<BoardType>::select(Player<BoardType> &attacker, Player<BoardType> &defender)
+{
+    switch (m_controller)
+    {
+        case MEDIUM_AI: return m_medium.select(attacker, defender);
+        case HARD_AI: return m_hard.select(attacker, defender);
+        case EXPERT_AI: return m_expert.select(attacker, defender);
+        default: return m_easy.select(attacker, defender);
+    }
+}
+
+template <class BoardType>
+void AnyStrategy<BoardType>::observe(int cell, const Shot &shot)
+{
+    switch (m_controller)
+    {
+        case MEDIUM_AI: m_medium.observe(cell, shot); break;
+        case HARD_AI: m_hard.observe(cell, shot); break;
+        case EXPERT_AI: m_expert.observe(cell, shot); break;
+        default: m_easy.observe(cell, shot); break;
+    }
+}
+
+template class EasyStrategy<NormalBoard>;
+template class EasyStrategy<XLBoard>;
+template class MediumStrategy<NormalBoard>;
+template class MediumStrategy<XLBoard>;
+template class HardStrategy<NormalBoard>;
+template class HardStrategy<XLBoard>;
+template class ExpertStrategy<NormalBoard>;
+template class ExpertStrategy<XLBoard>;
+template class AnyStrategy<NormalBoard>;
+template class AnyStrategy<XLBoard>;
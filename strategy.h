@@ -0,0 +1,238 @@
+/*------------------------------------------------------------
+ * @Filename: strategy.h
+ * @Description: the targeting strategies an AI side can play, picked at compile time or at run time
+ ------------------------------------------------------------*/
+
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include "player.h"
+#include "machine.h"
+#include "medium.h"
+#include "hard.h"
+#include "expert.h"
+#include "stats.h"
+
+/**
+ * @brief Who makes the decisions for one side of the game
+ *
+ */
+enum Controller
+{
+    HUMAN_CONTROLLER,
+    EASY_AI,
+    MEDIUM_AI,
+    HARD_AI,
+    EXPERT_AI
+};
+
+/**
+ * @brief Convert a difficulty level ('E', 'M', 'H' or 'X' for expert) to the AI which plays it
+ *
+ * @param difficulty The difficulty level
+ * @return Controller The matching AI controller
+ */
+Controller controllerForDifficulty(char difficulty);
+
+/*
+ * A targeting strategy is any class with these members, for one board type:
+ *
+ *     void reset(uint64_t seed, int side);
+ *         Start a new game. Every random choice is drawn from streams of
+ *         seed kept for that strategy and side, so a game replays exactly.
+ *
+ *     int select(Player<BoardType> &attacker, Player<BoardType> &defender);
+ *         Choose an untried cell (row * numCols + col) to fire at. Does not fire.
+ *
+ *     void observe(int cell, const Shot &shot);
+ *         Learn the outcome of the shot just fired at the selected cell.
+ *
+ * A mask-based strategy also (or instead) has
+ *
+ *     int select(const EnemyView<BoardType> &view);
+ *
+ * and decides from the side's marks on the enemy board and the ships it has
+ * sunk (player.h), never the Player objects, so it can play in a BatchEngine
+ * lane (batch_engine.h). Easy and Hard are mask-based.
+ *
+ * playGame (game_engine.h) is templated on the two sides' strategies, so
+ * their calls inline into the game loop. AnyStrategy picks one of the
+ * built-in strategies by Controller at run time, for the interactive game.
+ */
+
+/**
+ * @brief Fires at a random untried cell
+ *
+ */
+template <class BoardType>
+class EasyStrategy
+{
+    public:
+        void reset(uint64_t seed, int side) { m_machine.seed(seed, 6 + side); }
+
+        int select(Player<BoardType> &attacker, Player<BoardType> &)
+        {
+            STATS_TIMER(decision, AI_DECISIONS_EASY, AI_NANOSECONDS_EASY, 0);
+            STATS_COUNT(RANDOM_SHOTS);
+            return attacker.untried_cells.sample(m_machine);
+        }
+
+        // The same draw, so a game plays identically in a BatchEngine lane
+        int select(const EnemyView<BoardType> &view)
+        {
+            STATS_TIMER(decision, AI_DECISIONS_EASY, AI_NANOSECONDS_EASY, 0);
+            STATS_COUNT(RANDOM_SHOTS);
+            return view.untried->sample(m_machine);
+        }
+
+        void observe(int, const Shot &) {}
+
+    private:
+        Machine m_machine;
+};
+
+/**
+ * @brief Medium, firing at a random untried cell whenever it has no shot of its own
+ *
+ */
+template <class BoardType>
+class MediumStrategy
+{
+    public:
+        void reset(uint64_t seed, int side)
+        {
+            m_medium = Medium<BoardType>();
+            m_medium.seed(seed, side);
+            m_fallback.seed(seed, 8 + side);
+            m_chosen = false;
+        }
+
+        int select(Player<BoardType> &attacker, Player<BoardType> &defender)
+        {
+            STATS_TIMER(decision, AI_DECISIONS_MEDIUM, AI_NANOSECONDS_MEDIUM, 0);
+            int cell = m_medium.chooseShot(attacker, defender);
+            m_chosen = cell >= 0;
+            if (m_chosen) return cell;
+
+            STATS_COUNT(MEDIUM_GIVE_UPS);
+            STATS_COUNT(RANDOM_SHOTS);
+            return attacker.untried_cells.sample(m_fallback);
+        }
+
+        // Medium only follows up the shots it chose
+        void observe(int cell, const Shot &shot)
+        {
+            if (m_chosen) m_medium.observe(cell, shot);
+        }
+
+    private:
+        Medium<BoardType> m_medium;
+        Machine m_fallback;
+        bool m_chosen;
+};
+
+/**
+ * @brief Hard: the cell the most possible ship placements cover
+ *
+ */
+template <class BoardType>
+class HardStrategy
+{
+    public:
+        void reset(uint64_t seed, int side) { m_hard.seed(seed, 2 + side); }
+
+        int select(Player<BoardType> &attacker, Player<BoardType> &defender)
+        {
+            STATS_TIMER(decision, AI_DECISIONS_HARD, AI_NANOSECONDS_HARD, 0);
+            return m_hard.chooseShot(attacker, defender);
+        }
+
+        int select(const EnemyView<BoardType> &view)
+        {
+            STATS_TIMER(decision, AI_DECISIONS_HARD, AI_NANOSECONDS_HARD, 0);
+            return m_hard.chooseShot(view);
+        }
+
+        void observe(int, const Shot &) {}
+
+    private:
+        Hard<BoardType> m_hard;
+};
+
+/**
+ * @brief Expert: the cell occupied in the most sampled enemy fleets, or the exact endgame shot
+ *
+ */
+template <class BoardType>
+class ExpertStrategy
+{
+    public:
+        void reset(uint64_t seed, int side) { m_expert.seed(seed, 4 + side); }
+
+        /**
+         * @brief Set how much work the AI may do per move; see Expert::setBudget
+         *
+         */
+        void setBudget(int samples, int milliseconds) { m_expert.setBudget(samples, milliseconds); }
+
+        int select(Player<BoardType> &attacker, Player<BoardType> &defender)
+        {
+            STATS_TIMER(decision, AI_DECISIONS_EXPERT, AI_NANOSECONDS_EXPERT, 0);
+            return m_expert.chooseShot(attacker, defender);
+        }
+
+        void observe(int, const Shot &) {}
+
+    private:
+        Expert<BoardType> m_expert;
+};
+
+/**
+ * @brief Whichever built-in strategy a Controller names, chosen at run time
+ *
+ * Every call is one switch on the controller. The simulator avoids even
+ * that by playing the concrete strategies through playGame.
+ */
+template <class BoardType>
+class AnyStrategy
+{
+    public:
+        AnyStrategy();
+
+        /**
+         * @brief Choose the strategy; takes effect from the next reset
+         *
+         * @param controller An AI controller; HUMAN_CONTROLLER selects nothing and plays as Easy
+         */
+        void setController(Controller controller);
+
+        Controller getController() const { return m_controller; }
+
+        void setExpertBudget(int samples, int milliseconds);
+
+        void reset(uint64_t seed, int side);
+
+        int select(Player<BoardType> &attacker, Player<BoardType> &defender);
+
+        void observe(int cell, const Shot &shot);
+
+    private:
+        Controller m_controller;
+        EasyStrategy<BoardType> m_easy;
+        MediumStrategy<BoardType> m_medium;
+        HardStrategy<BoardType> m_hard;
+        ExpertStrategy<BoardType> m_expert;
+};
+
+extern template class EasyStrategy<NormalBoard>;
+extern template class EasyStrategy<XLBoard>;
+extern template class MediumStrategy<NormalBoard>;
+extern template class MediumStrategy<XLBoard>;
+extern template class HardStrategy<NormalBoard>;
+extern template class HardStrategy<XLBoard>;
+extern template class ExpertStrategy<NormalBoard>;
+extern template class ExpertStrategy<XLBoard>;
+extern template class AnyStrategy<NormalBoard>;
+extern template class AnyStrategy<XLBoard>;
+
+#endif
@@ -0,0 +1,122 @@
+#include "thread_pool.h"
+
+namespace
+{
+    thread_local int t_workerId = -1;
+    thread_local const ThreadPool *t_pool = nullptr;   // the pool t_workerId belongs to
+}
+
+ThreadPool::ThreadPool(int numThreads) : m_queued(0), m_pending(0), m_nextQueue(0), m_stop(false)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = static_cast<int>(std::thread::hardware_concurrency());
+        if (numThreads <= 0) numThreads = 1;
+    }
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        m_queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (int i = 0; i < numThreads; i++)
+    {
+        m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> guard(m_sleepLock);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++)
+    {
+        m_threads[i].join();
+    }
+}
+
+int ThreadPool::getNumThreads() const { return static_cast<int>(m_threads.size()); }
+
+int ThreadPool::currentWorker() { return t_workerId; }
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    // A worker of some other pool is an outside thread as far as this pool is concerned
+    int id = t_pool == this ? t_workerId : -1;
+    if (id < 0)
+    {
+        id = static_cast<int>(m_nextQueue++ % m_queues.size());
+    }
+
+    m_pending++;
+    {
+        std::lock_guard<std::mutex> guard(m_queues[id]->lock);
+        m_queues[id]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> guard(m_sleepLock);
+        m_queued++;
+    }
+    m_wake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_sleepLock);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+}
+
+bool ThreadPool::popLocal(int id, Task &task)
+{
+    Queue &queue = *m_queues[id];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int id, Task &task)
+{
+    int numQueues = static_cast<int>(m_queues.size());
+    for (int offset = 1; offset < numQueues; offset++)
+    {
+        Queue &victim = *m_queues[(id + offset) % numQueues];
+        std::unique_lock<std::mutex> guard(victim.lock, std::try_to_lock);
+        if (!guard.owns_lock() || victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int id)
+{
+    t_workerId = id;
+    t_pool = this;
+    Task task;
+
+    while (true)
+    {
+        if (popLocal(id, task) || steal(id, task))
+        {
+            m_queued--;
+            task();
+            task = Task();
+            if (--m_pending == 0)
+            {
+                std::lock_guard<std::mutex> guard(m_sleepLock);
+                m_done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepLock);
+        m_wake.wait(lock, [this] { return m_stop || m_queued > 0; });
+        if (m_stop && m_queued <= 0) return;
+    }
+}
@@ -0,0 +1,104 @@
+/*------------------------------------------------------------
+ * @Filename: thread_pool.h
+ * @Description: fixed set of worker threads with work-stealing queues
+ ------------------------------------------------------------*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A pool of worker threads, each with its own task queue
+ *
+ * A worker runs tasks from the back of its own queue and, when that is empty,
+ * steals from the front of the other workers' queues. Tasks submitted from
+ * outside the pool (including from another pool's workers) are dealt out
+ * round-robin; tasks submitted by a worker go on that worker's own queue.
+ */
+class ThreadPool
+{
+    public:
+        /**
+         * @brief Start the worker threads
+         *
+         * @param numThreads The number of workers, or 0 for one per hardware thread
+         */
+        explicit ThreadPool(int numThreads = 0);
+
+        /**
+         * @brief Finish every queued task and stop the workers
+         *
+         */
+        ~ThreadPool();
+
+        /**
+         * @brief Queue a task to be run by some worker
+         *
+         * @param task The task to run
+         */
+        void submit(std::function<void()> task);
+
+        /**
+         * @brief Block until every submitted task has finished. Must not be called from a worker.
+         *
+         */
+        void wait();
+
+        /**
+         * @brief Get the number of worker threads
+         *
+         * @return int The number of workers
+         */
+        int getNumThreads() const;
+
+        /**
+         * @brief Get the index of the worker running the calling thread
+         *
+         * @return int 0 to getNumThreads() - 1, or -1 if called from outside any pool
+         */
+        static int currentWorker();
+
+    private:
+        typedef std::function<void()> Task;
+
+        struct Queue
+        {
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+
+        /**
+         * @brief Take a task from the back of a worker's own queue
+         *
+         */
+        bool popLocal(int id, Task &task);
+
+        /**
+         * @brief Take a task from the front of another worker's queue
+         *
+         */
+        bool steal(int id, Task &task);
+
+        void workerLoop(int id);
+
+        std::vector<std::unique_ptr<Queue> > m_queues;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_sleepLock;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        std::atomic<int> m_queued;
+        std::atomic<int> m_pending;
+        std::atomic<unsigned> m_nextQueue;
+        bool m_stop;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "transposition.h"
+#include "stats.h"
+
+template <class BoardType>
+TranspositionTable<BoardType>::TranspositionTable(int logEntries)
+{
+    uint64_t size = uint64_t(1) << logEntries;
+    m_slotMask = size - 1;
+    m_entries = new Entry[size];
+    for (uint64_t i = 0; i < size; i++)
+    {
+        m_entries[i].sequence.store(0, std::memory_order_relaxed);
+        m_entries[i].key.store(0, std::memory_order_relaxed);
+    }
+}
+
+template <class BoardType>
+TranspositionTable<BoardType>::~TranspositionTable()
+{
+    delete[] m_entries;
+}
+
+template <class BoardType>
+bool TranspositionTable<BoardType>::find(uint64_t key, Mask &value) const
+{
+    STATS_COUNT(TRANSPOSITION_PROBES);
+    const Entry &entry = m_entries[key & m_slotMask];
+
+    uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+    if (sequence == 0 || (sequence & 1) || entry.key.load(std::memory_order_relaxed) != key) return false;
+
+    Mask found;
+    for (int w = 0; w < Mask::WORDS; w++) found.m_words[w] = entry.words[w].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.sequence.load(std::memory_order_relaxed) != sequence) return false;   // rewritten while we read it
+
+    STATS_COUNT(TRANSPOSITION_HITS);
+    value = found;
+    return true;
+}
+
+template <class BoardType>
+void TranspositionTable<BoardType>::store(uint64_t key, const Mask &value)
+{
+    Entry &entry = m_entries[key & m_slotMask];
+
+    uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) || !entry.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+    {
+        return;   // another thread is writing this entry; its position is as good as ours
+    }
+    // Pairs with find's acquire fence: no reader sees the new data under the old even sequence
+    std::atomic_thread_fence(std::memory_order_release);
+
+    entry.key.store(key, std::memory_order_relaxed);
+    for (int w = 0; w < Mask::WORDS; w++) entry.words[w].store(value.m_words[w], std::memory_order_relaxed);
+    entry.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+template <class BoardType>
+TranspositionTable<BoardType> &TranspositionTable<BoardType>::shared()
+{
+    // About 2 MB for either board
+    static TranspositionTable table(BoardType::CELLS > 128 ? 15 : 16);
+    return table;
+}
+
+template class TranspositionTable<NormalBoard>;
+template class TranspositionTable<XLBoard>;
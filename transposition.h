@@ -0,0 +1,113 @@
+/*------------------------------------------------------------
+ * @Filename: transposition.h
+ * @Description: a fixed-size table of AI decisions keyed by position hash, shared between threads without locks
+ ------------------------------------------------------------*/
+
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include "board.h"
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Hash everything an AI's view of the enemy fleet is made of
+ *
+ * Two positions with the same key have the same marks, the same sunk ships
+ * where they sank and the same ships afloat, however they were reached.
+ *
+ * @param marks The Zobrist hash of the attacker's hits and misses, as Board::getHash gives it
+ * @param sunkCells The cells of the sunk ships
+ * @param floating Which ships are still afloat, by ship number
+ * @param numShips The number of ships
+ * @return uint64_t The key
+ */
+template <int Bits>
+uint64_t positionKey(uint64_t marks, const Bitboard<Bits> &sunkCells, const bool floating[], int numShips)
+{
+    uint64_t key = marks ^ Zobrist::keyOf(Zobrist::SUNK, sunkCells);
+    for (int ship = 1; ship <= numShips; ship++)
+    {
+        if (floating[ship]) key ^= Zobrist::key(Zobrist::FLOATING, ship);
+    }
+    return key;
+}
+
+/**
+ * @brief The same key, from the attacker's view of the enemy board
+ *
+ */
+template <class BoardType>
+uint64_t positionKey(const BoardType &view, const typename BoardType::Mask &sunkCells, const bool floating[], int numShips)
+{
+    return positionKey(view.getHash(), sunkCells, floating, numShips);
+}
+
+/**
+ * @brief Remembers a cell mask per position hash, such as the cells an AI found best to fire at
+ *
+ * The table has a fixed number of entries and a new position simply
+ * overwrites whatever shared its slot, so memory stays bounded however many
+ * games are played. Any thread may look up or store at any time. Each entry
+ * carries a sequence number which is odd while it is being written: a store
+ * which finds the entry busy is dropped, and a lookup which sees the number
+ * odd or changed underneath it reports a miss. Nothing ever waits.
+ */
+template <class BoardType>
+class TranspositionTable
+{
+    public:
+        typedef typename BoardType::Mask Mask;
+
+        /**
+         * @brief Construct an empty table
+         *
+         * @param logEntries The table has 2^logEntries entries
+         */
+        explicit TranspositionTable(int logEntries);
+
+        ~TranspositionTable();
+
+        /**
+         * @brief Look up a position
+         *
+         * @param key The position's hash
+         * @param value Set to the stored mask if found
+         * @return true The position was found
+         * @return false It was not, or its entry was being written
+         */
+        bool find(uint64_t key, Mask &value) const;
+
+        /**
+         * @brief Store a position's mask, replacing whatever was in its slot
+         *
+         * @param key The position's hash
+         * @param value The mask
+         */
+        void store(uint64_t key, const Mask &value);
+
+        /**
+         * @brief Get the table shared by every AI in the process for this board type
+         *
+         */
+        static TranspositionTable &shared();
+
+    private:
+        TranspositionTable(const TranspositionTable &);
+        TranspositionTable &operator=(const TranspositionTable &);
+
+        struct Entry
+        {
+            std::atomic<uint32_t> sequence;   // 0 while empty, odd while being written
+            std::atomic<uint64_t> key;
+            std::atomic<uint64_t> words[Mask::WORDS];
+        };
+
+        Entry *m_entries;
+        uint64_t m_slotMask;
+};
+
+extern template class TranspositionTable<NormalBoard>;
+extern template class TranspositionTable<XLBoard>;
+
+#endif
@@ -0,0 +1,97 @@
+/*------------------------------------------------------------
+ * @Filename: untried_cells.h
+ * @Description: the cells a player has not fired at yet, sampled in O(1)
+ ------------------------------------------------------------*/
+
+#ifndef UNTRIED_CELLS_H
+#define UNTRIED_CELLS_H
+
+#include "machine.h"
+
+/**
+ * @brief A dense list of the cells not yet fired at, with each cell's position in it
+ *
+ * Cells are numbered row * numCols + col. The first size() entries of
+ * m_cells are the untried cells; removing one swaps it with the last untried
+ * entry, so remove and sample are both constant time and sampling never has to
+ * retry on a cell which was already fired at.
+ */
+template <int Cells>
+class UntriedCells
+{
+    public:
+        /**
+         * @brief Construct a list holding every cell
+         *
+         */
+        UntriedCells() { reset(); }
+
+        /**
+         * @brief Put every cell back in the list
+         *
+         */
+        void reset()
+        {
+            for (int i = 0; i < Cells; i++)
+            {
+                m_cells[i] = static_cast<short>(i);
+                m_position[i] = static_cast<short>(i);
+            }
+            m_count = Cells;
+        }
+
+        /**
+         * @brief Get the number of untried cells
+         *
+         * @return int The number of cells left
+         */
+        int size() const { return m_count; }
+
+        /**
+         * @brief Check whether a cell has not been fired at
+         *
+         * @param cell The cell to check
+         * @return true The cell is untried
+         * @return false The cell was removed
+         */
+        bool contains(int cell) const { return m_position[cell] < m_count; }
+
+        /**
+         * @brief Get the i-th untried cell, in no particular order
+         *
+         * @param i An index in [0, size())
+         * @return int The cell
+         */
+        int get(int i) const { return m_cells[i]; }
+
+        /**
+         * @brief Mark a cell as fired at. Removing a cell twice has no effect.
+         *
+         * @param cell The cell to remove
+         */
+        void remove(int cell)
+        {
+            if (!contains(cell)) return;
+            int position = m_position[cell];
+            int last = m_cells[--m_count];
+            m_cells[position] = static_cast<short>(last);
+            m_position[last] = static_cast<short>(position);
+            m_cells[m_count] = static_cast<short>(cell);
+            m_position[cell] = static_cast<short>(m_count);
+        }
+
+        /**
+         * @brief Pick an untried cell uniformly at random. The list must not be empty.
+         *
+         * @param machine The random number source
+         * @return int The cell
+         */
+        int sample(Machine &machine) const { return m_cells[machine.randomBelow(m_count)]; }
+
+    private:
+        short m_cells[Cells];
+        short m_position[Cells];
+        int m_count;
+};
+
+#endif